@@ -35,6 +35,10 @@ struct TBContext {
     /* statistics */
     unsigned tb_flush_count;
     unsigned tb_phys_invalidate_count;
+    unsigned tb_evict_count;
+    unsigned tb_evict_tb_count;
+    size_t tcg_op_count; /* TCG ops emitted, after optimization */
+    size_t tcg_insn_count; /* guest instructions translated */
 };
 
 extern TBContext tb_ctx;
@@ -799,6 +799,70 @@ void tb_flush(CPUState *cpu)
     }
 }
 
+static gboolean tb_evict_one(gpointer key, gpointer value, gpointer data)
+{
+    TranslationBlock *tb = value;
+    unsigned *nb_tbs = data;
+
+    if (!(tb_cflags(tb) & CF_INVALID)) {
+        tb_phys_invalidate(tb, -1);
+    }
+    (*nb_tbs)++;
+    return false;
+}
+
+static void do_tb_evict(CPUState *cpu, run_on_cpu_data tb_evict_count)
+{
+    unsigned nb_tbs = 0;
+    bool did_evict = false;
+
+    mmap_lock();
+    /* If it is already been done on request of another CPU, just retry. */
+    if (tb_ctx.tb_evict_count != tb_evict_count.host_int) {
+        mmap_unlock();
+        return;
+    }
+
+    /*
+     * Each TB of the region is unlinked from the lookup structures and
+     * from the jump lists of the other TBs, so that no remaining code
+     * may branch into the region once it is reallocated.
+     */
+    qemu_thread_jit_write();
+    did_evict = tcg_region_evict(tb_evict_one, &nb_tbs);
+    qemu_thread_jit_execute();
+    if (did_evict) {
+        qatomic_inc(&tb_ctx.tb_evict_count);
+        qatomic_set(&tb_ctx.tb_evict_tb_count,
+                    tb_ctx.tb_evict_tb_count + nb_tbs);
+    }
+    mmap_unlock();
+
+    /*
+     * Plugins are not notified: their per-TB callback data are only
+     * reclaimed on a full flush, as live TBs may still reference them.
+     */
+    if (!did_evict) {
+        /* every region is in use by a TCG context */
+        do_tb_flush(cpu, RUN_ON_CPU_HOST_INT(
+                             qatomic_read(&tb_ctx.tb_flush_count)));
+    }
+}
+
+void tb_evict(CPUState *cpu)
+{
+    if (tcg_enabled()) {
+        unsigned tb_evict_count = qatomic_read(&tb_ctx.tb_evict_count);
+
+        if (cpu_in_serial_context(cpu)) {
+            do_tb_evict(cpu, RUN_ON_CPU_HOST_INT(tb_evict_count));
+        } else {
+            async_safe_run_on_cpu(cpu, do_tb_evict,
+                                  RUN_ON_CPU_HOST_INT(tb_evict_count));
+        }
+    }
+}
+
 /* remove @orig from its @n_orig-th jump list */
 static inline void tb_remove_from_jmp_list(TranslationBlock *orig, int n_orig)
 {
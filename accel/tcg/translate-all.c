@@ -316,8 +316,8 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
     assert_no_pages_locked();
     tb = tcg_tb_alloc(tcg_ctx);
     if (unlikely(!tb)) {
-        /* flush must be done */
-        tb_flush(cpu);
+        /* recycle the oldest region, or flush if none can be released */
+        tb_evict(cpu);
         mmap_unlock();
         /* Make the execution loop process the flush as soon as possible.  */
         cpu->exception_index = EXCP_INTERRUPT;
@@ -421,6 +421,9 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
     }
     tcg_ctx->gen_tb = NULL;
 
+    qatomic_add(&tb_ctx.tcg_op_count, tcg_ctx->nb_ops);
+    qatomic_add(&tb_ctx.tcg_insn_count, tb->icount);
+
     search_size = encode_search(tb, (void *)gen_code_buf + gen_code_size);
     if (unlikely(search_size < 0)) {
         tb_unlock_pages(tb);
@@ -9,6 +9,11 @@
  *    https://github.com/openocd-org/openocd/blob/master/
  *       doc/manual/jtag/drivers/remote_bitbang.txt
  *
+ * The OpenOCD JTAG VPI protocol is also supported as an alternative, scan
+ * vector based, transport:
+ *    https://github.com/openocd-org/openocd/blob/master/
+ *       src/jtag/drivers/jtag_vpi.c
+ *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
  * in the Software without restriction, including without limitation the rights
@@ -29,6 +34,7 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/bswap.h"
 #include "qemu/error-report.h"
 #include "qemu/log.h"
 #include "qemu/module.h"
@@ -92,12 +98,17 @@ typedef struct TapCtrlRbbState {
 
     guint watch_tag; /* tracker for comm device change */
 
+    /* JTAG VPI command buffer */
+    uint8_t *vpi_cmd;
+    unsigned vpi_len; /* count of received bytes in vpi_cmd */
+
     /* properties */
     CharBackend chr;
     uint32_t idcode; /* TAP controller identifier */
     uint8_t ir_length; /* count of meaningful bits in ir */
     uint8_t idcode_inst; /* instruction to get ID code */
     bool enable_quit; /* whether VM quit can be remotely triggered */
+    bool vpi; /* use JTAG VPI protocol rather than remote bitbang */
 } TapCtrlRbbState;
 
 typedef struct _TAPRegisterState {
@@ -120,6 +131,32 @@ typedef struct _TAPProcess {
 
 #define TAP_CTRL_BYPASS_INST 0u
 
+/*
+ * JTAG VPI command, as defined by OpenOCD:
+ * - command, 32-bit LE
+ * - output buffer (TDI or TMS bits, LSB first)
+ * - input buffer (TDO bits, LSB first)
+ * - length of the output buffer in bytes, 32-bit LE
+ * - count of meaningful bits in the output buffer, 32-bit LE
+ * The whole command is sent back to the peer for scan commands, with the
+ * input buffer filled in.
+ */
+#define VPI_XFERT_MAX_SIZE 512u
+#define VPI_CMD_OFFSET     0u
+#define VPI_OUT_OFFSET     (VPI_CMD_OFFSET + sizeof(uint32_t))
+#define VPI_IN_OFFSET      (VPI_OUT_OFFSET + VPI_XFERT_MAX_SIZE)
+#define VPI_LENGTH_OFFSET  (VPI_IN_OFFSET + VPI_XFERT_MAX_SIZE)
+#define VPI_NB_BITS_OFFSET (VPI_LENGTH_OFFSET + sizeof(uint32_t))
+#define VPI_CMD_SIZE       (VPI_NB_BITS_OFFSET + sizeof(uint32_t))
+
+typedef enum {
+    VPI_CMD_RESET,
+    VPI_CMD_TMS_SEQ,
+    VPI_CMD_SCAN_CHAIN,
+    VPI_CMD_SCAN_CHAIN_FLIP_TMS,
+    VPI_CMD_STOP_SIMU,
+} TapCtrlVpiCmd;
+
 /*
  * TAP controller state machine state/event matrix
  *
@@ -417,10 +454,99 @@ static void tap_ctrl_rbb_reset_tap(TapCtrlRbbState *tap, bool trst, bool srst)
     tap->srst = srst;
 }
 
+/*
+ * Run a full TCK cycle, return the TDO level sampled before the rising edge.
+ * The falling edge is skipped if TCK is already low, so that the falling edge
+ * action of a state is never run twice; TDI and TMS are nevertheless latched
+ * as the rising edge samples them.
+ */
+static bool tap_ctrl_rbb_clock(TapCtrlRbbState *tap, bool tms, bool tdi)
+{
+    if (tap->tck) {
+        tap_ctrl_rbb_step(tap, false, tms, tdi);
+    } else {
+        tap->tdi = tdi;
+        tap->tms = tms;
+    }
+    bool tdo = tap->tdo;
+    tap_ctrl_rbb_step(tap, true, tms, tdi);
+
+    return tdo;
+}
+
 /*
  * TAP Server implementation
  */
 
+static void tap_ctrl_rbb_vpi_shift(TapCtrlRbbState *tap, bool scan, bool flip)
+{
+    const uint8_t *out = &tap->vpi_cmd[VPI_OUT_OFFSET];
+    uint8_t *in = &tap->vpi_cmd[VPI_IN_OFFSET];
+    unsigned nb_bits = ldl_le_p(&tap->vpi_cmd[VPI_NB_BITS_OFFSET]);
+
+    if (nb_bits > VPI_XFERT_MAX_SIZE * 8u) {
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: invalid bit count %u\n", __func__,
+                      nb_bits);
+        nb_bits = VPI_XFERT_MAX_SIZE * 8u;
+    }
+
+    if (scan) {
+        memset(in, 0, VPI_XFERT_MAX_SIZE);
+    }
+
+    bool tms = false;
+    bool tdi = tap->tdi;
+    for (unsigned ix = 0; ix < nb_bits; ix++) {
+        bool bit = (bool)((out[ix >> 3u] >> (ix & 7u)) & 1u);
+        if (scan) {
+            tdi = bit;
+            tms = flip && (ix == nb_bits - 1u);
+            if (tap_ctrl_rbb_clock(tap, tms, tdi)) {
+                in[ix >> 3u] |= 1u << (ix & 7u);
+            }
+        } else {
+            tms = bit;
+            tap_ctrl_rbb_clock(tap, tms, tdi);
+        }
+    }
+
+    if (nb_bits) {
+        /* run the falling edge action of the final state */
+        tap_ctrl_rbb_step(tap, false, tms, tdi);
+    }
+}
+
+/* @return true if the command should be sent back to the peer */
+static bool tap_ctrl_rbb_vpi_execute(TapCtrlRbbState *tap)
+{
+    unsigned cmd = ldl_le_p(&tap->vpi_cmd[VPI_CMD_OFFSET]);
+
+    trace_tap_ctrl_rbb_vpi_cmd(cmd,
+                               ldl_le_p(&tap->vpi_cmd[VPI_NB_BITS_OFFSET]));
+
+    switch (cmd) {
+    case VPI_CMD_RESET:
+        tap_ctrl_rbb_tap_reset(tap);
+        return false;
+    case VPI_CMD_TMS_SEQ:
+        tap_ctrl_rbb_vpi_shift(tap, false, false);
+        return false;
+    case VPI_CMD_SCAN_CHAIN:
+        tap_ctrl_rbb_vpi_shift(tap, true, false);
+        return true;
+    case VPI_CMD_SCAN_CHAIN_FLIP_TMS:
+        tap_ctrl_rbb_vpi_shift(tap, true, true);
+        return true;
+    case VPI_CMD_STOP_SIMU:
+        tap_ctrl_rbb_quit(tap);
+        return false;
+    default:
+        qemu_log_mask(LOG_UNIMP, "%s: Unknown VPI command %u\n", __func__,
+                      cmd);
+        return false;
+    }
+}
+
 static bool tap_ctrl_rbb_read_byte(TapCtrlRbbState *tap, uint8_t ch)
 {
     switch ((char)ch) {
@@ -487,13 +613,31 @@ static int tap_ctrl_rbb_chr_can_receive(void *opaque)
     TapCtrlRbbState *tap = (TapCtrlRbbState *)opaque;
 
     /* do not accept any input till a TAP controller is available */
-    return qemu_chr_fe_backend_connected(&tap->chr) ? MAX_PACKET_LENGTH : 0;
+    if (!qemu_chr_fe_backend_connected(&tap->chr)) {
+        return 0;
+    }
+
+    /* never receive more than the remaining bytes of a VPI command */
+    return tap->vpi ? (int)(VPI_CMD_SIZE - tap->vpi_len) : MAX_PACKET_LENGTH;
 }
 
 static void tap_ctrl_rbb_chr_receive(void *opaque, const uint8_t *buf, int size)
 {
     TapCtrlRbbState *tap = (TapCtrlRbbState *)opaque;
 
+    if (tap->vpi) {
+        g_assert(tap->vpi_len + (unsigned)size <= VPI_CMD_SIZE);
+        memcpy(&tap->vpi_cmd[tap->vpi_len], buf, (size_t)size);
+        tap->vpi_len += (unsigned)size;
+        if (tap->vpi_len == VPI_CMD_SIZE) {
+            tap->vpi_len = 0;
+            if (tap_ctrl_rbb_vpi_execute(tap)) {
+                qemu_chr_fe_write_all(&tap->chr, tap->vpi_cmd, VPI_CMD_SIZE);
+            }
+        }
+        return;
+    }
+
     for (unsigned ix = 0; ix < size; ix++) {
         if (tap_ctrl_rbb_read_byte(tap, buf[ix])) {
             uint8_t outbuf[1] = { '0' + (unsigned)tap->tdo };
@@ -512,6 +656,7 @@ static void tap_ctrl_rbb_chr_event_hander(void *opaque, QEMUChrEvent event)
         }
 
         tap_ctrl_rbb_tap_reset(tap);
+        tap->vpi_len = 0;
     }
 }
 
@@ -537,6 +682,7 @@ static int tap_ctrl_rbb_chr_be_change(void *opaque)
                              &tap_ctrl_rbb_chr_be_change, tap, NULL, true);
 
     tap_ctrl_rbb_tap_reset(tap);
+    tap->vpi_len = 0;
 
     if (tap->watch_tag > 0) {
         g_source_remove(tap->watch_tag);
@@ -620,6 +766,7 @@ static Property tap_ctrl_rbb_properties[] = {
     DEFINE_PROP_UINT8("ir_length", TapCtrlRbbState, ir_length, 0),
     DEFINE_PROP_UINT8("idcode_inst", TapCtrlRbbState, idcode_inst, 1u),
     DEFINE_PROP_BOOL("quit", TapCtrlRbbState, enable_quit, true),
+    DEFINE_PROP_BOOL("vpi", TapCtrlRbbState, vpi, false),
     DEFINE_PROP_CHR("chardev", TapCtrlRbbState, chr),
     DEFINE_PROP_END_OF_LIST(),
 };
@@ -664,6 +811,10 @@ static void tap_ctrl_rbb_realize(DeviceState *dev, Error **errp)
     g_assert(tdh);
     tdh->opaque = (void *)(uintptr_t)tap->idcode;
 
+    if (tap->vpi) {
+        tap->vpi_cmd = g_new0(uint8_t, VPI_CMD_SIZE);
+    }
+
     qemu_chr_fe_set_handlers(&tap->chr, &tap_ctrl_rbb_chr_can_receive,
                              &tap_ctrl_rbb_chr_receive,
                              &tap_ctrl_rbb_chr_event_hander,
@@ -34,6 +34,7 @@
 #include "qemu/timer.h"
 #include "qemu/typedefs.h"
 #include "hw/opentitan/ot_aes.h"
+#include "hw/opentitan/ot_aes_ecb.h"
 #include "hw/opentitan/ot_alert.h"
 #include "hw/opentitan/ot_clkmgr.h"
 #include "hw/opentitan/ot_common.h"
@@ -44,7 +45,6 @@
 #include "hw/riscv/ibex_common.h"
 #include "hw/riscv/ibex_irq.h"
 #include "hw/sysbus.h"
-#include "tomcrypt.h"
 #include "trace.h"
 
 #undef DEBUG_AES
@@ -122,7 +122,7 @@ REG32(STATUS, 0x84u)
 
 #define OT_AES_DATA_SIZE (PARAM_NUM_REGS_DATA * sizeof(uint32_t))
 #define OT_AES_KEY_SIZE  (PARAM_NUM_REGS_KEY * sizeof(uint32_t))
-#define OT_AES_IV_SIZE   (PARAM_NUM_REGS_KEY * sizeof(uint32_t))
+#define OT_AES_IV_SIZE   (PARAM_NUM_REGS_IV * sizeof(uint32_t))
 
 /* arbitrary value long enough to give back execution to vCPU */
 #define OT_AES_RETARD_DELAY_NS 10000u /* 10 us */
@@ -200,13 +200,8 @@ typedef struct OtAESRegisters {
 } OtAESRegisters;
 
 typedef struct OtAESContext {
-    union {
-        symmetric_ECB ecb;
-        symmetric_CFB cfb;
-        symmetric_OFB ofb;
-        symmetric_CBC cbc;
-        symmetric_CTR ctr;
-    };
+    OtAESEcbKey enc_key; /* expanded encryption key */
+    OtAESEcbKey dec_key; /* expanded decryption key, ECB and CBC only */
     uint64_t key[OT_AES_KEY_SIZE / sizeof(uint64_t)];
     uint64_t iv[OT_AES_IV_SIZE / sizeof(uint64_t)];
     uint8_t src[OT_AES_DATA_SIZE];
@@ -215,7 +210,6 @@ typedef struct OtAESContext {
     bool iv_ready; /* IV has been fully loaded */
     bool di_full; /* Input DATA FIFO fully filled */
     bool do_full; /* Output DATA FIFO not empty */
-    int aes_cipher; /* AES handle for tomcrypt */
 } OtAESContext;
 
 typedef struct OtAESEDN {
@@ -670,85 +664,32 @@ static void ot_aes_update_config(OtAESState *s)
     size_t key_size = ot_aes_get_key_length(r);
     enum OtAESMode mode = ot_aes_get_mode(r);
 
-    int rc;
-
-    switch (mode) {
-    case AES_ECB:
-        rc = ecb_start(c->aes_cipher, (const uint8_t *)c->key, (int)key_size, 0,
-                       &c->ecb);
-        break;
-    case AES_CBC:
-        rc = cbc_start(c->aes_cipher, (const uint8_t *)c->iv,
-                       (const uint8_t *)c->key, (int)key_size, 0, &c->cbc);
-        break;
-    case AES_CFB:
-        rc = cfb_start(c->aes_cipher, (const uint8_t *)c->iv,
-                       (const uint8_t *)c->key, (int)key_size, 0, &c->cfb);
-        break;
-    case AES_OFB:
-        rc = ofb_start(c->aes_cipher, (const uint8_t *)c->iv,
-                       (const uint8_t *)c->key, (int)key_size, 0, &c->ofb);
-        break;
-    case AES_CTR:
-        rc = ctr_start(c->aes_cipher, (const uint8_t *)c->iv,
-                       (const uint8_t *)c->key, (int)key_size, 0,
-                       CTR_COUNTER_BIG_ENDIAN, &c->ctr);
-        break;
-    default:
-        /* cannot happen */
-        return;
+    /*
+     * only the block cipher runs in the inverse direction on decryption, and
+     * only for the ECB and CBC modes: the other modes use the block cipher
+     * to generate a key stream.
+     */
+    ot_aes_ecb_set_key(&c->enc_key, (const uint8_t *)c->key, key_size);
+    if (mode == AES_ECB || mode == AES_CBC) {
+        ot_aes_ecb_set_decrypt_key(&c->dec_key, (const uint8_t *)c->key,
+                                   key_size);
     }
 
     trace_ot_aes_key(s, OT_AES_MODE_NAMES[mode], c->key, key_size);
     trace_ot_aes_iv(s, OT_AES_MODE_NAMES[mode], c->iv);
-
-    if (rc != CRYPT_OK) {
-        error_report("OpenTitan AES [%s]: Unable to initialize AES API: %d",
-                     OT_AES_MODE_NAMES[mode], rc);
-        /* @todo how to report this? */
-    }
 }
 
 static void ot_aes_finalize(OtAESState *s, enum OtAESMode mode)
 {
-    int rc;
-
     OtAESContext *c = s->ctx;
 
-    /*
-     * libtomcrypt's cipher filed needs to be tested, as the initialization
-     * function may have never been called prior to the finalization, in which
-     * case the matching *_done function should not be called
-     */
-
-    switch (mode) {
-    case AES_NONE:
-        return;
-    case AES_ECB:
-        rc = c->ecb.cipher == c->aes_cipher ? ecb_done(&c->ecb) : CRYPT_OK;
-        break;
-    case AES_CBC:
-        rc = c->cbc.cipher == c->aes_cipher ? cbc_done(&c->cbc) : CRYPT_OK;
-        break;
-    case AES_CFB:
-        rc = c->cfb.cipher == c->aes_cipher ? cfb_done(&c->cfb) : CRYPT_OK;
-        break;
-    case AES_OFB:
-        rc = c->ofb.cipher == c->aes_cipher ? ofb_done(&c->ofb) : CRYPT_OK;
-        break;
-    case AES_CTR:
-        rc = c->ctr.cipher == c->aes_cipher ? ctr_done(&c->ctr) : CRYPT_OK;
-        break;
-    default:
-        /* cannot happen */
+    if (mode == AES_NONE) {
         return;
     }
 
-    if (rc != CRYPT_OK) {
-        error_report("OpenTitan AES [%s]: Unable to finalize AES API: %d",
-                     OT_AES_MODE_NAMES[mode], rc);
-        /* @todo how to report this? */
-    }
+    /* do not leave expanded key material behind */
+    memset(&c->enc_key, 0, sizeof(c->enc_key));
+    memset(&c->dec_key, 0, sizeof(c->dec_key));
 
     c->di_full = false;
     c->do_full = false;
@@ -777,6 +718,23 @@ static void ot_aes_push(OtAESState *s)
     r->status |= R_STATUS_OUTPUT_VALID_MASK;
 }
 
+static void ot_aes_xor_block(uint8_t *dst, const uint8_t *a, const uint8_t *b)
+{
+    for (unsigned ix = 0; ix < OT_AES_DATA_SIZE; ix++) {
+        dst[ix] = a[ix] ^ b[ix];
+    }
+}
+
+static void ot_aes_increment_counter(uint8_t *ctr)
+{
+    /* the counter spans the whole IV, stored as a big-endian integer */
+    for (unsigned ix = OT_AES_IV_SIZE; ix-- > 0;) {
+        if (++ctr[ix]) {
+            break;
+        }
+    }
+}
+
 static void ot_aes_process(OtAESState *s)
 {
     OtAESRegisters *r = s->regs;
@@ -784,87 +742,64 @@ static void ot_aes_process(OtAESState *s)
 
     enum OtAESMode mode = ot_aes_get_mode(s->regs);
     bool encrypt = ot_aes_is_encryption(r);
-
-    int rc;
+    uint8_t *iv = (uint8_t *)c->iv;
+    uint8_t buf[OT_AES_DATA_SIZE];
 
     xtrace_ot_aes_debug("process");
 
-    if (encrypt) {
-        trace_ot_aes_buf(s, OT_AES_MODE_NAMES[mode], "enc/in ", c->src);
-        switch (mode) {
-        case AES_ECB:
-            rc = ecb_encrypt(c->src, c->dst, OT_AES_DATA_SIZE, &c->ecb);
-            break;
-        case AES_CBC:
-            rc = cbc_encrypt(c->src, c->dst, OT_AES_DATA_SIZE, &c->cbc);
-            break;
-        case AES_CFB:
-            rc = cfb_encrypt(c->src, c->dst, OT_AES_DATA_SIZE, &c->cfb);
-            break;
-        case AES_OFB:
-            rc = ofb_encrypt(c->src, c->dst, OT_AES_DATA_SIZE, &c->ofb);
-            break;
-        case AES_CTR:
-            rc = ctr_encrypt(c->src, c->dst, OT_AES_DATA_SIZE, &c->ctr);
-            break;
-        case AES_NONE:
-        default:
-            rc = CRYPT_ERROR;
-            break;
+    /*
+     * IV registers are updated on each block, as the hardware does: with the
+     * cipher text for CBC and CFB, with the block cipher output for OFB, and
+     * with the incremented counter for CTR.
+     */
+    trace_ot_aes_buf(s, OT_AES_MODE_NAMES[mode],
+                     encrypt ? "enc/in " : "dec/in ", c->src);
+    switch (mode) {
+    case AES_ECB:
+        if (encrypt) {
+            ot_aes_ecb_encrypt(&c->enc_key, c->src, c->dst, 1u);
+        } else {
+            ot_aes_ecb_decrypt(&c->dec_key, c->src, c->dst, 1u);
         }
-        trace_ot_aes_buf(s, OT_AES_MODE_NAMES[mode], "enc/out", c->dst);
-    } else {
-        trace_ot_aes_buf(s, OT_AES_MODE_NAMES[mode], "dec/in ", c->src);
-        switch (mode) {
-        case AES_ECB:
-            rc = ecb_decrypt(c->src, c->dst, OT_AES_DATA_SIZE, &c->ecb);
-            break;
-        case AES_CBC:
-            rc = cbc_decrypt(c->src, c->dst, OT_AES_DATA_SIZE, &c->cbc);
-            break;
-        case AES_CFB:
-            rc = cfb_decrypt(c->src, c->dst, OT_AES_DATA_SIZE, &c->cfb);
-            break;
-        case AES_OFB:
-            rc = ofb_decrypt(c->src, c->dst, OT_AES_DATA_SIZE, &c->ofb);
-            break;
-        case AES_CTR:
-            rc = ctr_decrypt(c->src, c->dst, OT_AES_DATA_SIZE, &c->ctr);
-            break;
-        case AES_NONE:
-        default:
-            rc = CRYPT_ERROR;
-            break;
+        break;
+    case AES_CBC:
+        if (encrypt) {
+            ot_aes_xor_block(buf, c->src, iv);
+            ot_aes_ecb_encrypt(&c->enc_key, buf, c->dst, 1u);
+            memcpy(iv, c->dst, OT_AES_IV_SIZE);
+        } else {
+            ot_aes_ecb_decrypt(&c->dec_key, c->src, buf, 1u);
+            ot_aes_xor_block(c->dst, buf, iv);
+            memcpy(iv, c->src, OT_AES_IV_SIZE);
         }
-        trace_ot_aes_buf(s, OT_AES_MODE_NAMES[mode], "dec/out", c->dst);
+        break;
+    case AES_CFB:
+        ot_aes_ecb_encrypt(&c->enc_key, iv, buf, 1u);
+        ot_aes_xor_block(c->dst, c->src, buf);
+        memcpy(iv, encrypt ? c->dst : c->src, OT_AES_IV_SIZE);
+        break;
+    case AES_OFB:
+        ot_aes_ecb_encrypt(&c->enc_key, iv, iv, 1u);
+        ot_aes_xor_block(c->dst, c->src, iv);
+        break;
+    case AES_CTR:
+        ot_aes_ecb_encrypt(&c->enc_key, iv, buf, 1u);
+        ot_aes_xor_block(c->dst, c->src, buf);
+        ot_aes_increment_counter(iv);
+        break;
+    case AES_NONE:
+    default:
+        error_report("OpenTitan AES [%s]: Unable to run AES",
+                     OT_AES_MODE_NAMES[mode]);
+        /* @todo how to report this? */
+        c->di_full = false;
+        return;
     }
+    trace_ot_aes_buf(s, OT_AES_MODE_NAMES[mode],
+                     encrypt ? "enc/out" : "dec/out", c->dst);
 
     c->di_full = false;
-
-    if (rc == CRYPT_OK) {
-        /* IV registers are updated on each round */
-        switch (mode) {
-        case AES_CBC:
-            memcpy(c->iv, c->cbc.IV, sizeof(c->iv));
-            break;
-        case AES_CFB:
-            memcpy(c->iv, c->cfb.IV, sizeof(c->iv));
-            break;
-        case AES_OFB:
-            memcpy(c->iv, c->ofb.IV, sizeof(c->iv));
-            break;
-        case AES_CTR:
-            memcpy(c->iv, c->ctr.ctr, sizeof(c->iv));
-            break;
-        default:
-            break;
-        }
-        c->do_full = true;
-    } else {
-        error_report("OpenTitan AES [%s]: Unable to run AES: %d",
-                     OT_AES_MODE_NAMES[mode], rc);
-        /* @todo how to report this? */
-    }
+    c->do_full = true;
 }
 
 static inline void ot_aes_do_process(OtAESState *s)
@@ -1048,7 +983,7 @@ static uint64_t ot_aes_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_AES_IO_READ_OUT);
     trace_ot_aes_io_read_out((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     return (uint64_t)val32;
@@ -1064,7 +999,7 @@ static void ot_aes_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_AES_IO_WRITE);
     trace_ot_aes_io_write((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -1261,12 +1196,6 @@ static void ot_aes_init(Object *obj)
     s->regs = g_new0(OtAESRegisters, 1u);
     s->ctx = g_new0(OtAESContext, 1u);
 
-    /* aes_desc is defined in libtomcrypt */
-    s->ctx->aes_cipher = register_cipher(&aes_desc);
-    if (s->ctx->aes_cipher < 0) {
-        error_report("OpenTitan AES: Unable to use libtomcrypt AES API");
-    }
-
     for (unsigned ix = 0; ix < PARAM_NUM_ALERTS; ix++) {
         ibex_qdev_init_irq(obj, &s->alerts[ix], OT_DEVICE_ALERT);
     }
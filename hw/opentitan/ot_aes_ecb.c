@@ -0,0 +1,142 @@
+/*
+ * QEMU OpenTitan AES ECB block cipher helper
+ *
+ * Copyright (c) 2024 Rivos, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/bswap.h"
+#include "hw/opentitan/ot_aes_ecb.h"
+
+/* count of blocks processed in parallel to fill the AES unit pipeline */
+#define OT_AES_ECB_LANES 4u
+
+static void ot_aes_ecb_import_key(OtAESEcbKey *key, AES_KEY *aes_key)
+{
+    /*
+     * AES_KEY round keys are stored as big-endian words, whereas the AES
+     * round primitives expect the round key bytes in the standard order.
+     */
+    key->rounds = (unsigned)aes_key->rounds;
+    for (unsigned rix = 0; rix <= key->rounds; rix++) {
+        for (unsigned wix = 0; wix < 4u; wix++) {
+            stl_be_p(&key->rk[rix].b[wix * sizeof(uint32_t)],
+                     aes_key->rd_key[rix * 4u + wix]);
+        }
+    }
+
+    memset(aes_key, 0, sizeof(*aes_key));
+}
+
+void ot_aes_ecb_set_key(OtAESEcbKey *key, const uint8_t *secret, size_t size)
+{
+    AES_KEY aes_key;
+
+    g_assert(size == 16u || size == 24u || size == 32u);
+
+    int rc = AES_set_encrypt_key(secret, (int)(size * 8u), &aes_key);
+    g_assert(rc == 0);
+
+    ot_aes_ecb_import_key(key, &aes_key);
+}
+
+void ot_aes_ecb_set_decrypt_key(OtAESEcbKey *key, const uint8_t *secret,
+                                size_t size)
+{
+    AES_KEY aes_key;
+
+    g_assert(size == 16u || size == 24u || size == 32u);
+
+    /*
+     * the decryption schedule is reversed, and InvMixColumns is applied to
+     * the inner round keys, as expected by the equivalent inverse cipher.
+     */
+    int rc = AES_set_decrypt_key(secret, (int)(size * 8u), &aes_key);
+    g_assert(rc == 0);
+
+    ot_aes_ecb_import_key(key, &aes_key);
+}
+
+void ot_aes_ecb_encrypt(const OtAESEcbKey *key, const uint8_t *in,
+                        uint8_t *out, unsigned count)
+{
+    AESState st[OT_AES_ECB_LANES];
+
+    while (count) {
+        unsigned lanes = MIN(count, OT_AES_ECB_LANES);
+
+        /*
+         * interleave the rounds of independent blocks, so that the latency of
+         * each round is hidden when host AES instructions are used.
+         */
+        for (unsigned lix = 0; lix < lanes; lix++) {
+            memcpy(st[lix].b, &in[lix * OT_AES_ECB_BLOCK_SIZE],
+                   OT_AES_ECB_BLOCK_SIZE);
+            st[lix].v ^= key->rk[0u].v;
+        }
+        for (unsigned rix = 1u; rix < key->rounds; rix++) {
+            for (unsigned lix = 0; lix < lanes; lix++) {
+                aesenc_SB_SR_MC_AK(&st[lix], &st[lix], &key->rk[rix], false);
+            }
+        }
+        for (unsigned lix = 0; lix < lanes; lix++) {
+            aesenc_SB_SR_AK(&st[lix], &st[lix], &key->rk[key->rounds], false);
+            memcpy(&out[lix * OT_AES_ECB_BLOCK_SIZE], st[lix].b,
+                   OT_AES_ECB_BLOCK_SIZE);
+        }
+
+        in += lanes * OT_AES_ECB_BLOCK_SIZE;
+        out += lanes * OT_AES_ECB_BLOCK_SIZE;
+        count -= lanes;
+    }
+}
+
+void ot_aes_ecb_decrypt(const OtAESEcbKey *key, const uint8_t *in,
+                        uint8_t *out, unsigned count)
+{
+    AESState st[OT_AES_ECB_LANES];
+
+    while (count) {
+        unsigned lanes = MIN(count, OT_AES_ECB_LANES);
+
+        for (unsigned lix = 0; lix < lanes; lix++) {
+            memcpy(st[lix].b, &in[lix * OT_AES_ECB_BLOCK_SIZE],
+                   OT_AES_ECB_BLOCK_SIZE);
+            st[lix].v ^= key->rk[0u].v;
+        }
+        for (unsigned rix = 1u; rix < key->rounds; rix++) {
+            for (unsigned lix = 0; lix < lanes; lix++) {
+                aesdec_ISB_ISR_IMC_AK(&st[lix], &st[lix], &key->rk[rix],
+                                      false);
+            }
+        }
+        for (unsigned lix = 0; lix < lanes; lix++) {
+            aesdec_ISB_ISR_AK(&st[lix], &st[lix], &key->rk[key->rounds],
+                              false);
+            memcpy(&out[lix * OT_AES_ECB_BLOCK_SIZE], st[lix].b,
+                   OT_AES_ECB_BLOCK_SIZE);
+        }
+
+        in += lanes * OT_AES_ECB_BLOCK_SIZE;
+        out += lanes * OT_AES_ECB_BLOCK_SIZE;
+        count -= lanes;
+    }
+}
@@ -788,7 +788,7 @@ static uint64_t ot_alert_regs_read(void *opaque, hwaddr addr, unsigned size)
 
     val32 = (*s->access_table[reg].read)(s, reg);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_ALERT_IO_READ_OUT);
     trace_ot_alert_io_read_out(s->ot_id, (uint32_t)addr, REG_NAME(s, reg),
                                val32, pc);
 
@@ -804,7 +804,7 @@ static void ot_alert_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_ALERT_IO_WRITE);
     trace_ot_alert_io_write(s->ot_id, (uint32_t)addr, REG_NAME(s, reg), val32,
                             pc);
 
@@ -39,6 +39,7 @@
 #include "hw/registerfields.h"
 #include "hw/riscv/ibex_common.h"
 #include "hw/riscv/ibex_irq.h"
+#include "migration/vmstate.h"
 #include "trace.h"
 
 /* clang-format off */
@@ -346,7 +347,7 @@ static uint64_t ot_aon_timer_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_AON_TIMER_READ_OUT);
     trace_ot_aon_timer_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                                 pc);
 
@@ -362,7 +363,7 @@ static void ot_aon_timer_write(void *opaque, hwaddr addr, uint64_t value,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_AON_TIMER_WRITE);
     trace_ot_aon_timer_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                              pc);
 
@@ -488,6 +489,27 @@ static Property ot_aon_timer_properties[] = {
     DEFINE_PROP_END_OF_LIST(),
 };
 
+static const VMStateDescription vmstate_ot_aon_timer = {
+    .name = TYPE_OT_AON_TIMER,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32_ARRAY(regs, OtAonTimerState, REGS_COUNT),
+        VMSTATE_INT64(wkup_origin_ns, OtAonTimerState),
+        VMSTATE_INT64(wdog_origin_ns, OtAonTimerState),
+        VMSTATE_BOOL(wdog_bite, OtAonTimerState),
+        VMSTATE_TIMER_PTR(wkup_timer, OtAonTimerState),
+        VMSTATE_TIMER_PTR(wdog_timer, OtAonTimerState),
+        VMSTATE_IBEX_IRQ(irq_wkup, OtAonTimerState),
+        VMSTATE_IBEX_IRQ(irq_bark, OtAonTimerState),
+        VMSTATE_IBEX_IRQ(nmi_bark, OtAonTimerState),
+        VMSTATE_IBEX_IRQ(pwrmgr_wkup, OtAonTimerState),
+        VMSTATE_IBEX_IRQ(pwrmgr_bite, OtAonTimerState),
+        VMSTATE_IBEX_IRQ(alert, OtAonTimerState),
+        VMSTATE_END_OF_LIST(),
+    },
+};
+
 static void ot_aon_timer_reset(DeviceState *dev)
 {
     OtAonTimerState *s = OT_AON_TIMER(dev);
@@ -542,6 +564,7 @@ static void ot_aon_timer_class_init(ObjectClass *klass, void *data)
 
     dc->reset = ot_aon_timer_reset;
     dc->realize = ot_aon_timer_realize;
+    dc->vmsd = &vmstate_ot_aon_timer;
     device_class_set_props(dc, ot_aon_timer_properties);
 }
 
@@ -29,12 +29,12 @@
  */
 
 #include "qemu/osdep.h"
-#include "qemu/guest-random.h"
 #include "qemu/log.h"
 #include "qemu/timer.h"
 #include "qemu/typedefs.h"
 #include "hw/opentitan/ot_ast_dj.h"
 #include "hw/opentitan/ot_common.h"
+#include "hw/opentitan/ot_prng.h"
 #include "hw/opentitan/ot_random_src.h"
 #include "hw/qdev-properties.h"
 #include "hw/registerfields.h"
@@ -132,6 +132,7 @@ static const char REGB_NAMES[REGSB_COUNT][6U] = {
 
 typedef struct {
     QEMUTimer *timer;
+    OtPrngState *prng;
     uint64_t *buffer;
     bool avail;
 } OtASTDjRandom;
@@ -203,8 +204,8 @@ static void ot_ast_dj_random_scheduler(void *opaque)
     OtASTDjState *s = opaque;
     OtASTDjRandom *rnd = &s->random;
 
-    qemu_guest_getrandom_nofail(rnd->buffer,
-                                OT_RANDOM_SRC_DWORD_COUNT * sizeof(uint64_t));
+    ot_prng_random_buffer(rnd->prng, rnd->buffer,
+                          OT_RANDOM_SRC_DWORD_COUNT * sizeof(uint64_t));
 
     rnd->avail = true;
 }
@@ -273,7 +274,7 @@ static uint64_t ot_ast_dj_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_AST_IO_READ_OUT);
     trace_ot_ast_io_read_out((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     return (uint64_t)val32;
@@ -288,7 +289,7 @@ static void ot_ast_dj_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_AST_IO_WRITE);
     trace_ot_ast_io_write((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -428,6 +429,7 @@ static void ot_ast_dj_init(Object *obj)
     OtASTDjRandom *rnd = &s->random;
 
     rnd->timer = timer_new_ns(OT_VIRTUAL_CLOCK, &ot_ast_dj_random_scheduler, s);
+    rnd->prng = ot_prng_allocate();
     rnd->buffer = g_new0(uint64_t, OT_RANDOM_SRC_DWORD_COUNT);
 }
 
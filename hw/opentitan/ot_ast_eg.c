@@ -29,10 +29,10 @@
  */
 
 #include "qemu/osdep.h"
-#include "qemu/guest-random.h"
 #include "qemu/log.h"
 #include "qemu/typedefs.h"
 #include "hw/opentitan/ot_ast_eg.h"
+#include "hw/opentitan/ot_prng.h"
 #include "hw/qdev-properties.h"
 #include "hw/registerfields.h"
 #include "hw/riscv/ibex_common.h"
@@ -134,15 +134,16 @@ struct OtASTEgState {
 
     uint32_t *regsa;
     uint32_t *regsb;
+    OtPrngState *prng; /* noise source */
 };
 
 /* -------------------------------------------------------------------------- */
 /* Public API */
 /* -------------------------------------------------------------------------- */
 
-void ot_ast_eg_getrandom(void *buf, size_t len)
+void ot_ast_eg_getrandom(OtASTEgState *s, void *buf, size_t len)
 {
-    qemu_guest_getrandom_nofail(buf, len);
+    ot_prng_random_buffer(s->prng, buf, len);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -213,7 +214,7 @@ static uint64_t ot_ast_eg_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_AST_IO_READ_OUT);
     trace_ot_ast_io_read_out((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     return (uint64_t)val32;
@@ -228,7 +229,7 @@ static void ot_ast_eg_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_AST_IO_WRITE);
     trace_ot_ast_io_write((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -356,6 +357,7 @@ static void ot_ast_eg_init(Object *obj)
 
     s->regsa = g_new0(uint32_t, REGSA_COUNT);
     s->regsb = g_new0(uint32_t, REGSB_COUNT);
+    s->prng = ot_prng_allocate();
 }
 
 static void ot_ast_eg_class_init(ObjectClass *klass, void *data)
@@ -298,7 +298,7 @@ static uint64_t ot_clkmgr_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_CLKMGR_IO_READ_OUT);
     trace_ot_clkmgr_io_read_out((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     return (uint64_t)val32;
@@ -313,7 +313,7 @@ static void ot_clkmgr_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_CLKMGR_IO_WRITE);
     trace_ot_clkmgr_io_write((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -33,16 +33,25 @@
 #include "qemu/option.h"
 #include "qemu/option_int.h"
 #include "qemu/queue.h"
+#include "qemu/timer.h"
 #include "qemu/typedefs.h"
 #include "qapi/error.h"
 #include "qapi/util.h"
 #include "qom/object.h"
+#include "hw/core/cpu.h"
 #include "hw/opentitan/ot_common.h"
 #include "hw/opentitan/ot_rom_ctrl.h"
 #include "hw/opentitan/ot_rom_ctrl_img.h"
 #include "hw/riscv/ibex_common.h"
+#include "migration/blocker.h"
 #include "trace.h"
 
+/*
+ * Count of consecutive reads of the same register from the same instruction
+ * before a poll loop is assumed.
+ */
+#define POLL_WATCH_THRESHOLD 4u
+
 typedef struct OtCommonObjectNode {
     Object *obj;
     QSIMPLEQ_ENTRY(OtCommonObjectNode) node;
@@ -221,6 +230,62 @@ AddressSpace *ot_common_get_local_address_space(DeviceState *s)
     return cpu ? cpu->as : NULL;
 }
 
+typedef struct {
+    const char *const *stateless_types;
+    DeviceState *dev;
+} OtCommonMigrationScan;
+
+static int ot_common_find_unmigratable_device(Object *child, void *opaque)
+{
+    OtCommonMigrationScan *scan = opaque;
+
+    DeviceState *dev = (DeviceState *)object_dynamic_cast(child, TYPE_DEVICE);
+    if (!dev) {
+        return 0;
+    }
+
+    /* vCPU state is registered on its own, see cpu_vmstate_register() */
+    if (object_dynamic_cast(child, TYPE_CPU)) {
+        return 0;
+    }
+
+    for (const char *const *type = scan->stateless_types; *type; type++) {
+        if (object_dynamic_cast(child, *type)) {
+            return 0;
+        }
+    }
+
+    if (!qdev_get_vmsd(dev)) {
+        scan->dev = dev;
+        return 1;
+    }
+
+    return 0;
+}
+
+void ot_common_block_unmigratable_devices(Error **blocker, Object *root,
+                                          const char *const *stateless_types)
+{
+    if (*blocker) {
+        return;
+    }
+
+    OtCommonMigrationScan scan = {
+        .stateless_types = stateless_types,
+        .dev = NULL,
+    };
+
+    if (object_child_foreach_recursive(root,
+                                       &ot_common_find_unmigratable_device,
+                                       &scan)) {
+        char *path = object_get_canonical_path(OBJECT(scan.dev));
+        error_setg(blocker, "device %s (%s) does not support migration",
+                   object_get_typename(OBJECT(scan.dev)), path);
+        g_free(path);
+        migrate_add_blocker(blocker, &error_fatal);
+    }
+}
+
 static void
 ot_common_configure_device_opts(DeviceState **devices, unsigned count)
 {
@@ -341,6 +406,50 @@ void ot_common_configure_devices_with_id(
     ibex_connect_devices(devices, defs, count);
 }
 
+void ot_common_poll_watch_init(OtPollWatch *pw, QEMUTimer *timer)
+{
+    memset(pw, 0, sizeof(*pw));
+    pw->timer = timer;
+}
+
+bool ot_common_poll_watch(OtPollWatch *pw, const char *id, hwaddr addr)
+{
+    if (!timer_pending(pw->timer)) {
+        pw->count = 0u;
+        return false;
+    }
+
+    /* accesses that are not initiated from a vCPU are never considered */
+    uint32_t pc = ibex_get_current_pc();
+    if (!pc) {
+        return false;
+    }
+
+    if (pw->addr != addr || pw->pc != pc) {
+        pw->addr = addr;
+        pw->pc = pc;
+        pw->count = 1u;
+        return false;
+    }
+
+    if (++pw->count < POLL_WATCH_THRESHOLD) {
+        return false;
+    }
+
+    pw->count = 0u;
+
+    int64_t now = qemu_clock_get_ns(OT_VIRTUAL_CLOCK);
+    int64_t deadline = (int64_t)timer_expire_time_ns(pw->timer);
+    if (deadline <= now) {
+        return false;
+    }
+
+    trace_ot_common_poll_fast_forward(id, (uint32_t)addr, pc, deadline - now);
+    timer_mod(pw->timer, now);
+
+    return true;
+}
+
 int ot_common_string_ends_with(const char *str, const char *suffix)
 {
     size_t str_len = strlen(str);
@@ -34,6 +34,7 @@
 #include "qemu/queue.h"
 #include "qemu/timer.h"
 #include "qemu/typedefs.h"
+#include "hw/opentitan/ot_aes_ecb.h"
 #include "hw/opentitan/ot_alert.h"
 #include "hw/opentitan/ot_common.h"
 #include "hw/opentitan/ot_csrng.h"
@@ -45,7 +46,6 @@
 #include "hw/riscv/ibex_common.h"
 #include "hw/riscv/ibex_irq.h"
 #include "hw/sysbus.h"
-#include "tomcrypt.h"
 #include "trace.h"
 
 
@@ -210,6 +210,13 @@ static_assert(OT_CSRNG_AES_BLOCK_SIZE + OT_CSRNG_AES_KEY_SIZE ==
 
 #define ENTROPY_SRC_INITIAL_REQUEST_COUNT 5u
 
+/*
+ * Max. count of entropy packets delivered to a HW client app in a single
+ * filler BH run. Bounded so that a large generate command does not starve
+ * the main loop.
+ */
+#define HWAPP_FILL_BATCH_COUNT 8u
+
 enum {
     ALERT_RECOVERABLE,
     ALERT_FATAL,
@@ -245,7 +252,7 @@ typedef enum {
 } OtCSRNGFsmState;
 
 typedef struct {
-    symmetric_ECB ecb; /* AES ECB context for tomcrypt */
+    OtAESEcbKey aes_key; /* expanded AES key */
     uint8_t v_counter[OT_CSRNG_AES_BLOCK_SIZE]; /* V a.k.a. the counter */
     uint8_t key[OT_CSRNG_AES_KEY_SIZE];
     uint32_t material[OT_CSRNG_SEED_WORD_COUNT];
@@ -289,6 +296,7 @@ struct OtCSRNGState {
     IbexIRQ alerts[PARAM_NUM_ALERTS];
     QEMUBH *cmd_scheduler;
     QEMUTimer *entropy_scheduler;
+    OtPollWatch poll; /* SW_CMD_STS poll loop tracker */
 
     uint32_t *regs;
     bool enabled;
@@ -300,13 +308,13 @@ struct OtCSRNGState {
     unsigned es_retry_count;
     unsigned state_db_ix;
     int entropy_gennum;
-    int aes_cipher; /* AES handle for tomcrypt */
     OtCSRNGFsmState state;
     OtCSRNGInstance *instances;
     OtCSRNGQueue cmd_requests;
 
     DeviceState *random_src;
     OtOTPState *otp_ctrl;
+    bool fast_poll; /* retry commands early on SW_CMD_STS poll loop */
 };
 
 static const uint8_t OtCSRNGFsmStateCode[] = {
@@ -452,6 +460,18 @@ int ot_csrng_push_command(OtCSRNGState *s, unsigned app_id,
     return 0;
 }
 
+void ot_csrng_report_status_poll(OtCSRNGState *s, DeviceState *dev,
+                                 hwaddr addr)
+{
+    if (!s->fast_poll) {
+        return;
+    }
+
+    ot_common_poll_watch(&s->poll,
+                         object_get_canonical_path_component(OBJECT(dev)),
+                         addr);
+}
+
 /* -------------------------------------------------------------------------- */
 /* DRBG (Deterministic Random Bit Generator) */
 /* -------------------------------------------------------------------------- */
@@ -546,15 +566,12 @@ static OtCSRNDCmdResult ot_csrng_drng_instantiate(
     uint8_t key[OT_CSRNG_AES_KEY_SIZE];
     memset(key, 0, sizeof(key));
 
-    int res;
-    res = ecb_start(inst->parent->aes_cipher, key, (int)sizeof(key), 0,
-                    &drng->ecb);
-    g_assert(res == CRYPT_OK);
+    ot_aes_ecb_set_key(&drng->aes_key, key, sizeof(key));
 
     memcpy(drng->key, key, OT_CSRNG_AES_KEY_SIZE);
     drng->instantiated = true;
 
-    res = ot_csrng_drng_reseed(inst, rand_dev, flag0);
+    int res = ot_csrng_drng_reseed(inst, rand_dev, flag0);
     if (res) {
         drng->instantiated = false;
         return res;
@@ -577,10 +594,6 @@ static void ot_csrng_drng_uninstantiate(OtCSRNGInstance *inst)
 {
     OtCSRNGDrng *drng = &inst->drng;
 
-    if (drng->instantiated) {
-        ecb_done(&drng->ecb);
-    }
-
     drng->instantiated = false;
     drng->seeded = false;
     drng->fips = false;
@@ -601,18 +614,15 @@ static void ot_csrng_drng_update(OtCSRNGInstance *inst)
                                 OT_CSRNG_AES_BLOCK_SIZE);
 
     uint32_t tmp[OT_CSRNG_SEED_WORD_COUNT];
-    int res;
-    memset(tmp, 0, sizeof(tmp));
     uint8_t *ptmp = (uint8_t *)tmp;
+    /* build all counter blocks first, then encrypt them in a single call */
     for (unsigned ix = 0; ix < OT_CSRNG_SEED_BYTE_COUNT;
          ix += OT_CSRNG_AES_BLOCK_SIZE) {
         ot_csrng_drng_increment(drng);
-
-        res = ecb_encrypt(drng->v_counter, ptmp, OT_CSRNG_AES_BLOCK_SIZE,
-                          &drng->ecb);
-        g_assert(res == CRYPT_OK);
-        ptmp += OT_CSRNG_AES_BLOCK_SIZE;
+        memcpy(&ptmp[ix], drng->v_counter, OT_CSRNG_AES_BLOCK_SIZE);
     }
+    ot_aes_ecb_encrypt(&drng->aes_key, ptmp, ptmp,
+                       OT_CSRNG_SEED_BYTE_COUNT / OT_CSRNG_AES_BLOCK_SIZE);
 
     for (unsigned ix = 0; ix < drng->material_len; ix++) {
         tmp[ix] ^= drng->material[ix];
@@ -620,13 +630,7 @@ static void ot_csrng_drng_update(OtCSRNGInstance *inst)
 
     ot_csrng_drng_clear_material(inst);
 
-    res = ecb_done(&drng->ecb);
-    g_assert(res == CRYPT_OK);
-
-    ptmp = (uint8_t *)tmp;
-    res = ecb_start(inst->parent->aes_cipher, ptmp, (int)OT_CSRNG_AES_KEY_SIZE,
-                    0, &drng->ecb);
-    g_assert(res == CRYPT_OK);
+    ot_aes_ecb_set_key(&drng->aes_key, ptmp, OT_CSRNG_AES_KEY_SIZE);
 
     memcpy(drng->key, ptmp, OT_CSRNG_AES_KEY_SIZE);
     memcpy(drng->v_counter, &ptmp[OT_CSRNG_AES_KEY_SIZE],
@@ -706,11 +710,7 @@ static void ot_csrng_drng_generate(OtCSRNGInstance *inst, uint32_t *out,
     ot_csrng_drng_increment(drng);
     drng->rem_packet_count -= 1u;
 
-    int res;
-
-    res = ecb_encrypt(drng->v_counter, (uint8_t *)out, OT_CSRNG_AES_BLOCK_SIZE,
-                      &drng->ecb);
-    g_assert(res == CRYPT_OK);
+    ot_aes_ecb_encrypt(&drng->aes_key, drng->v_counter, (uint8_t *)out, 1u);
 
     xtrace_ot_csrng_show_buffer(ot_csrng_get_slot(inst), "out", out,
                                 OT_CSRNG_AES_BLOCK_SIZE);
@@ -1219,7 +1219,9 @@ static void ot_csrng_hwapp_filler_bh(void *opaque)
      * client may have updated its readiness status since this BH has been
      * scheduled, readiness should always be tested
      */
-    if (inst->hw.genbits_ready && ot_csrng_drng_remaining_count(inst)) {
+    unsigned batch = HWAPP_FILL_BATCH_COUNT;
+    while (batch && inst->hw.genbits_ready &&
+           ot_csrng_drng_remaining_count(inst)) {
         uint32_t bits[OT_CSRNG_PACKET_WORD_COUNT];
         bool fips;
         ot_csrng_drng_generate(inst, bits, &fips);
@@ -1230,14 +1232,16 @@ static void ot_csrng_hwapp_filler_bh(void *opaque)
          * updated
          */
         inst->hw.filler(inst->hw.opaque, bits, fips);
+        batch -= 1u;
+    }
 
-        /*
-         * reschedule self if the client does not update its readiness, it
-         * expects more entropy from this instance.
-         */
-        if (ot_csrng_drng_remaining_count(inst)) {
-            qemu_bh_schedule(inst->hw.filler_bh);
-        }
+    /*
+     * reschedule self if the batch has been exhausted while the client still
+     * expects more entropy from this instance.
+     */
+    if (!batch && inst->hw.genbits_ready &&
+        ot_csrng_drng_remaining_count(inst)) {
+        qemu_bh_schedule(inst->hw.filler_bh);
     }
 
     /* check if the instance is running a deferred completion command */
@@ -1561,7 +1565,6 @@ static uint64_t ot_csrng_regs_read(void *opaque, hwaddr addr, unsigned size)
     case R_INTR_ENABLE:
     case R_REGWEN:
     case R_CTRL:
-    case R_SW_CMD_STS:
     case R_INT_STATE_NUM:
     case R_HW_EXC_STS:
     case R_RECOV_ALERT_STS:
@@ -1569,6 +1572,10 @@ static uint64_t ot_csrng_regs_read(void *opaque, hwaddr addr, unsigned size)
     case R_ERR_CODE_TEST:
         val32 = s->regs[reg];
         break;
+    case R_SW_CMD_STS:
+        ot_csrng_report_status_poll(s, DEVICE(s), addr);
+        val32 = s->regs[reg];
+        break;
     case R_INT_STATE_VAL:
         val32 = s->read_int_granted ? ot_csrng_read_state_db(s) : 0u;
         break;
@@ -1627,7 +1634,7 @@ static uint64_t ot_csrng_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_CSRNG_IO_READ_OUT);
     trace_ot_csrng_io_read_out((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     return (uint64_t)val32;
@@ -1643,7 +1650,7 @@ static void ot_csrng_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_CSRNG_IO_WRITE);
     trace_ot_csrng_io_write((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -1775,6 +1782,7 @@ static Property ot_csrng_properties[] = {
                      DeviceState *),
     DEFINE_PROP_LINK("otp_ctrl", OtCSRNGState, otp_ctrl, TYPE_OT_OTP,
                      OtOTPState *),
+    DEFINE_PROP_BOOL("fast-poll", OtCSRNGState, fast_poll, false),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -1842,12 +1850,6 @@ static void ot_csrng_init(Object *obj)
                           REGS_SIZE);
     sysbus_init_mmio(SYS_BUS_DEVICE(s), &s->mmio);
 
-    /* aes_desc is defined in libtomcrypt */
-    s->aes_cipher = register_cipher(&aes_desc);
-    if (s->aes_cipher < 0) {
-        error_report("%s: unable to use libtomcrypt AES API", __func__);
-    }
-
     s->regs = g_new0(uint32_t, REGS_COUNT);
     for (unsigned ix = 0; ix < PARAM_NUM_IRQS; ix++) {
         ibex_sysbus_init_irq(obj, &s->irqs[ix]);
@@ -1877,6 +1879,7 @@ static void ot_csrng_init(Object *obj)
     s->cmd_scheduler = qemu_bh_new(&ot_csrng_command_scheduler, s);
     s->entropy_scheduler =
         timer_new_ns(OT_VIRTUAL_CLOCK, &ot_csrng_command_scheduler, s);
+    ot_common_poll_watch_init(&s->poll, s->entropy_scheduler);
 
     QSIMPLEQ_INIT(&s->cmd_requests);
 }
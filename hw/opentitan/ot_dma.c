@@ -251,6 +251,7 @@ struct OtDMAState {
     IbexIRQ alerts[PARAM_NUM_ALERTS];
     AddressSpace *ases[AS_COUNT];
     QEMUTimer *timer;
+    OtPollWatch poll; /* STATUS poll loop tracker */
 
     OtDMASM state;
     OtDMAOp op;
@@ -266,6 +267,7 @@ struct OtDMAState {
 #ifdef OT_DMA_HAS_ROLE
     uint8_t role;
 #endif
+    bool fast_poll; /* pace transfers faster on STATUS poll loop */
 };
 
 #define R32_OFF(_r_) ((_r_) / sizeof(uint32_t))
@@ -1102,7 +1104,6 @@ static uint64_t ot_dma_regs_read(void *opaque, hwaddr addr, unsigned size)
     case R_DEST_ADDR_LIMIT_HI:
     case R_DEST_ADDR_THRESHOLD_LO:
     case R_DEST_ADDR_THRESHOLD_HI:
-    case R_STATUS:
     case R_ERROR_CODE:
     case R_HANDSHAKE_INTR:
     case R_CLEAR_INT_SRC:
@@ -1112,6 +1113,12 @@ static uint64_t ot_dma_regs_read(void *opaque, hwaddr addr, unsigned size)
     case R_INT_SRC_WR_VAL_0 ... R_INT_SRC_WR_VAL_10:
         val32 = s->regs[reg];
         break;
+    case R_STATUS:
+        if (s->fast_poll) {
+            ot_common_poll_watch(&s->poll, s->ot_id, addr);
+        }
+        val32 = s->regs[reg];
+        break;
     case R_CFG_REGWEN:
         val32 = ot_dma_is_configurable(s) ? OT_MULTIBITBOOL4_TRUE :
                                             OT_MULTIBITBOOL4_FALSE;
@@ -1134,7 +1141,7 @@ static uint64_t ot_dma_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_DMA_IO_READ_OUT);
     trace_ot_dma_io_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                              pc);
 
@@ -1150,7 +1157,7 @@ static void ot_dma_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_DMA_IO_WRITE);
     trace_ot_dma_io_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -1316,6 +1323,7 @@ static Property ot_dma_properties[] = {
 #ifdef OT_DMA_HAS_ROLE
     DEFINE_PROP_UINT8("role", OtDMAState, role, UINT8_MAX),
 #endif
+    DEFINE_PROP_BOOL("fast-poll", OtDMAState, fast_poll, false),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -1394,6 +1402,7 @@ static void ot_dma_init(Object *obj)
     }
 
     s->timer = timer_new_ns(OT_VIRTUAL_CLOCK, &ot_dma_transfer, s);
+    ot_common_poll_watch_init(&s->poll, s->timer);
 }
 
 static void ot_dma_class_init(ObjectClass *klass, void *data)
@@ -156,6 +156,14 @@ static const char *REG_NAMES[REGS_COUNT] = {
 
 #define ENDPOINT_COUNT_MAX 8u
 
+/*
+ * Depth of the entropy prefetch ring, in CSRNG packets. CSRNG keeps filling
+ * the ring as long as the current generate command has packets left, so that
+ * endpoint requests can be served from already buffered entropy rather than
+ * waiting for a CSRNG generation round-trip.
+ */
+#define PREFETCH_PACKET_COUNT 8u
+
 #define xtrace_ot_edn_error(_id_, _msg_) \
     trace_ot_edn_error(_id_, __func__, __LINE__, _msg_)
 #define xtrace_ot_edn_xinfo(_id_, _msg_, _val_) \
@@ -202,7 +210,7 @@ typedef struct {
     bool no_fips; /* true if 1+ rcv entropy packets were no FIPS-compliant */
     unsigned rem_packet_count; /* remaining expected packets in generate cmd */
     uint32_t buffer[OT_CSRNG_CMD_WORD_MAX]; /* temp buffer for commands */
-    OtFifo32 bits_fifo; /* input FIFO with entropy received from CSRNG */
+    OtFifo32 bits_fifo; /* input prefetch ring w/ entropy from CSRNG */
     OtFifo32 sw_cmd_fifo; /* generic command output FIFO */
     OtFifo32 cmd_gen_fifo; /* FIFO to store replayed generate command */
     OtFifo32 cmd_reseed_fifo; /* FIFO to store replayed reseed command */
@@ -231,6 +239,8 @@ struct OtEDNState {
     uint32_t *regs;
 
     unsigned reseed_counter; /* track remaining requests before reseeding */
+    uint64_t prefetch_hits; /* requests served from already buffered entropy */
+    uint64_t prefetch_misses; /* requests that had to wait for CSRNG */
     bool last_cmd_failed; /* status of the last CSRNG command */
     bool sw_cmd_ready; /* ready to receive command in SW port mode */
     OtEDNFsmState state; /* Main FSM state */
@@ -330,8 +340,34 @@ int ot_edn_request_entropy(OtEDNState *s, unsigned ep_id)
         return -1;
     }
 
+    /*
+     * a request is a prefetch hit if it can be fulfilled as soon as the
+     * endpoint BH runs, i.e. without waiting for CSRNG to generate entropy.
+     * Queued requests from endpoints with an empty unpacker are served first,
+     * each of them consumes a packet from the prefetch ring.
+     */
+    unsigned queued = 0;
+    OtEDNEndPoint *qep;
+    QSIMPLEQ_FOREACH(qep, &s->ep_requests, request) {
+        if (ot_fifo32_is_empty(&qep->fifo)) {
+            queued += 1u;
+        }
+    }
+    bool hit = !ot_fifo32_is_empty(&ep->fifo) ||
+               ot_fifo32_num_used(&s->rng.bits_fifo) /
+                       OT_CSRNG_PACKET_WORD_COUNT >
+                   queued;
+
     QSIMPLEQ_INSERT_TAIL(&s->ep_requests, ep, request);
 
+    if (hit) {
+        s->prefetch_hits += 1u;
+    } else {
+        s->prefetch_misses += 1u;
+    }
+    trace_ot_edn_prefetch(s->rng.appid, ep_id, hit, s->prefetch_hits,
+                          s->prefetch_misses);
+
     trace_ot_edn_schedule(s->rng.appid, "external entropy request");
     qemu_bh_schedule(s->ep_bh);
 
@@ -1072,6 +1108,8 @@ static uint64_t ot_edn_regs_read(void *opaque, hwaddr addr, unsigned size)
         val32 = s->regs[reg];
         break;
     case R_SW_CMD_STS:
+        /* SW commands complete once CSRNG has executed them */
+        ot_csrng_report_status_poll(s->rng.device, DEVICE(s), addr);
         val32 =
             FIELD_DP32(0, SW_CMD_STS, CMD_STS, (uint32_t)s->last_cmd_failed);
         val32 = FIELD_DP32(val32, SW_CMD_STS, CMD_RDY,
@@ -1104,7 +1142,7 @@ static uint64_t ot_edn_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_EDN_IO_READ_OUT);
     trace_ot_edn_io_read_out(s->rng.appid, (uint32_t)addr, REG_NAME(reg), val32,
                              pc);
 
@@ -1125,7 +1163,7 @@ static void ot_edn_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_EDN_IO_WRITE);
     trace_ot_edn_io_write(c->appid, (uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -1294,6 +1332,8 @@ static void ot_edn_reset(DeviceState *dev)
     s->regs[R_CTRL] = 0x9999u;
     s->regs[R_BOOT_INS_CMD] = 0x901u;
     s->regs[R_BOOT_GEN_CMD] = 0xfff003u;
+    s->prefetch_hits = 0;
+    s->prefetch_misses = 0;
 
     ot_edn_clean_up(s, true);
 
@@ -1328,7 +1368,8 @@ static void ot_edn_init(Object *obj)
 
     s->ep_bh = qemu_bh_new(&ot_edn_handle_ep_request, s);
 
-    ot_fifo32_create(&c->bits_fifo, OT_CSRNG_PACKET_WORD_COUNT * 2u);
+    ot_fifo32_create(&c->bits_fifo,
+                     OT_CSRNG_PACKET_WORD_COUNT * PREFETCH_PACKET_COUNT);
     ot_fifo32_create(&c->sw_cmd_fifo, OT_CSRNG_CMD_WORD_MAX);
     ot_fifo32_create(&c->cmd_gen_fifo, OT_CSRNG_CMD_WORD_MAX);
     ot_fifo32_create(&c->cmd_reseed_fifo, OT_CSRNG_CMD_WORD_MAX);
@@ -1339,6 +1380,11 @@ static void ot_edn_init(Object *obj)
     }
 
     QSIMPLEQ_INIT(&s->ep_requests);
+
+    object_property_add_uint64_ptr(obj, "prefetch-hits", &s->prefetch_hits,
+                                   OBJ_PROP_FLAG_READ);
+    object_property_add_uint64_ptr(obj, "prefetch-misses", &s->prefetch_misses,
+                                   OBJ_PROP_FLAG_READ);
 }
 
 static void ot_edn_class_init(ObjectClass *klass, void *data)
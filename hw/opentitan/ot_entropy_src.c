@@ -324,6 +324,11 @@ static const char *REG_NAMES[REGS_COUNT] = {
 #define ES_SWREAD_FIFO_WORD_COUNT      ES_WORD_COUNT
 #define ES_FINAL_FIFO_WORD_COUNT       (ES_WORD_COUNT * ES_FINAL_FIFO_DEPTH)
 #define ES_HEXBUF_SIZE                 ((8U * 2u + 1u) * ES_WORD_COUNT + 4u)
+/* HW packs 32-bit words into 64-bit SHA3 input packets */
+#define ES_PACKER_WORD_COUNT (sizeof(uint64_t) / sizeof(uint32_t))
+/* packets are buffered and fed to SHA3 as 512-bit blocks */
+#define ES_PRECON_WORD_COUNT 16u
+#define ES_COND_WORD_COUNT   (2048u / (8u * sizeof(uint32_t)))
 
 /* see hw/ip/edn/doc/#multiple-edns-in-boot-time-request-mode */
 #define OT_ENTROPY_SRC_BOOT_DELAY_NS 2000000u /* 2 ms */
@@ -370,7 +375,7 @@ struct OtEntropySrcState {
 
     uint32_t *regs;
     OtFifo32 input_fifo; /* not in real HW, used to reduce feed rate */
-    OtFifo32 precon_fifo; /* 32-to-64 SHA3 input packer */
+    OtFifo32 precon_fifo; /* 32-to-64 SHA3 input packer and block buffer */
     OtFifo32 bypass_fifo; /* 32-to-384 packer */
     OtFifo32 observe_fifo;
     OtFifo32 swread_fifo;
@@ -815,12 +820,34 @@ static bool ot_entropy_src_can_bypass_entropy(OtEntropySrcState *s)
     return false;
 }
 
+static bool ot_entropy_src_is_packer_empty(OtEntropySrcState *s)
+{
+    /* buffered words only count as pending if they do not form a packet */
+    return (ot_fifo32_num_used(&s->precon_fifo) % ES_PACKER_WORD_COUNT) == 0;
+}
+
+static void ot_entropy_src_flush_conditioner(OtEntropySrcState *s)
+{
+    if (ot_fifo32_is_empty(&s->precon_fifo)) {
+        return;
+    }
+
+    uint32_t size;
+    const uint32_t *buf;
+    buf = ot_fifo32_peek_buf(&s->precon_fifo, s->precon_fifo.num, &size);
+    g_assert(size == s->precon_fifo.num);
+    xtrace_ot_entropy_src_show_buffer("sha3 in", buf, size * sizeof(uint32_t));
+    int res = sha3_process(&s->sha3_state, (const uint8_t *)buf,
+                           size * sizeof(uint32_t));
+    g_assert(res == CRYPT_OK);
+    ot_fifo32_reset(&s->precon_fifo);
+}
+
 static bool
 ot_entropy_src_push_entropy_to_conditioner(OtEntropySrcState *s, uint32_t word)
 {
-    int res;
-    if (s->cond_word == 0) {
-        res = sha3_384_init(&s->sha3_state);
+    if (s->cond_word == 0 && ot_fifo32_is_empty(&s->precon_fifo)) {
+        int res = sha3_384_init(&s->sha3_state);
         ot_entropy_src_change_state(s, ENTROPY_SRC_SHA3_PREP);
         g_assert(res == CRYPT_OK);
     }
@@ -829,22 +856,21 @@ ot_entropy_src_push_entropy_to_conditioner(OtEntropySrcState *s, uint32_t word)
 
     ot_fifo32_push(&s->precon_fifo, word);
 
-    if (!ot_fifo32_is_full(&s->precon_fifo)) {
+    if (!ot_entropy_src_is_packer_empty(s)) {
         return false;
     }
 
     ot_entropy_src_change_state(s, ENTROPY_SRC_SHA3_PROCESS);
-
-    uint32_t size;
-    const uint32_t *buf;
-    buf = ot_fifo32_peek_buf(&s->precon_fifo, s->precon_fifo.num, &size);
-    g_assert(size == s->precon_fifo.num);
-    xtrace_ot_entropy_src_show_buffer("sha3 in", buf, size * sizeof(uint32_t));
-    res = sha3_process(&s->sha3_state, (const uint8_t *)buf,
-                       size * sizeof(uint32_t));
-    g_assert(res == CRYPT_OK);
-    s->cond_word += size;
-    ot_fifo32_reset(&s->precon_fifo);
+    s->cond_word += ES_PACKER_WORD_COUNT;
+
+    /*
+     * Defer SHA3 absorption till a whole block is buffered or the seed is
+     * complete, rather than hashing each 64-bit packet on its own.
+     */
+    if (ot_fifo32_is_full(&s->precon_fifo) ||
+        s->cond_word >= ES_COND_WORD_COUNT) {
+        ot_entropy_src_flush_conditioner(s);
+    }
 
     return true;
 }
@@ -852,13 +878,14 @@ ot_entropy_src_push_entropy_to_conditioner(OtEntropySrcState *s, uint32_t word)
 static bool ot_entropy_src_can_hash(OtEntropySrcState *s)
 {
     return ot_fifo32_is_empty(&s->precon_fifo) &&
-           (s->cond_word >= (2048 / (8u * sizeof(uint32_t))));
+           (s->cond_word >= ES_COND_WORD_COUNT);
 }
 
 static void ot_entropy_src_perform_hash(OtEntropySrcState *s)
 {
     uint32_t hash[OT_RANDOM_SRC_WORD_COUNT];
     int res;
+    ot_entropy_src_flush_conditioner(s);
     res = sha3_done(&s->sha3_state, (uint8_t *)hash);
     g_assert(res == CRYPT_OK);
     s->cond_word = 0;
@@ -922,74 +949,84 @@ static void ot_entropy_src_update_fw_route(OtEntropySrcState *s)
     }
 }
 
-static bool ot_entropy_src_consume_entropy(OtEntropySrcState *s, uint32_t word)
+static unsigned ot_entropy_src_consume_entropy(
+    OtEntropySrcState *s, const uint32_t *words, unsigned count)
 {
+    /* operating mode cannot change while a noise window is processed */
     bool fill_obs_fifo = ot_entropy_src_is_fw_ov_mode(s);
-    bool hw_path = !ot_entropy_src_is_fw_ov_entropy_insert(s);
+    bool hw_insert = !ot_entropy_src_is_fw_ov_entropy_insert(s);
     bool bypass = ot_entropy_src_is_bypass_mode(s);
+    bool fw_route = ot_entropy_src_is_fw_route(s);
 
-    if (hw_path) {
-        /* check that HW accept data */
-        hw_path = bypass ? ot_entropy_src_can_bypass_entropy(s) :
-                           ot_entropy_src_can_condition_entropy(s);
-    }
+    unsigned pos;
+    for (pos = 0; pos < count; pos++) {
+        uint32_t word = words[pos];
+        bool hw_path = hw_insert;
 
-    if (!(fill_obs_fifo || hw_path)) {
-        /* no way to consume noise, stop here */
-        trace_ot_entropy_src_info("cannot consume noise for now");
-        return false;
-    }
+        if (hw_path) {
+            /* check that HW accept data */
+            hw_path = bypass ? ot_entropy_src_can_bypass_entropy(s) :
+                               ot_entropy_src_can_condition_entropy(s);
+        }
 
-    s->noise_count += 1u;
-    trace_ot_entropy_src_consume_entropy(fill_obs_fifo, bypass, hw_path,
-                                         s->noise_count);
+        if (!(fill_obs_fifo || hw_path)) {
+            /* no way to consume noise, stop here */
+            trace_ot_entropy_src_info("cannot consume noise for now");
+            break;
+        }
 
-    if (fill_obs_fifo) {
-        if (ot_fifo32_is_full(&s->observe_fifo)) {
-            trace_ot_entropy_src_error("observe FIFO overflow",
-                                       STATE_NAME(s->state), s->state);
-            s->regs[R_FW_OV_RD_FIFO_OVERFLOW] |=
-                R_FW_OV_RD_FIFO_OVERFLOW_VAL_MASK;
-        } else {
-            if (s->obs_fifo_en) {
-                unsigned threshold = s->regs[R_OBSERVE_FIFO_THRESH];
-                ot_fifo32_push(&s->observe_fifo, word);
-                trace_ot_entropy_src_obs_fifo(ot_fifo32_num_used(
-                                                  &s->observe_fifo),
-                                              threshold);
-                if (ot_fifo32_is_full(&s->observe_fifo)) {
-                    /* can only be enabled back once the FIFO is emptied */
-                    trace_ot_entropy_src_info("observe FIFO is full");
-                    s->obs_fifo_en = false;
-                }
-                /* is it > or >= ? */
-                if (ot_fifo32_num_used(&s->observe_fifo) >= threshold) {
-                    s->regs[R_INTR_STATE] |= INTR_ES_OBSERVE_FIFO_READY_MASK;
-                }
+        if (fill_obs_fifo) {
+            if (ot_fifo32_is_full(&s->observe_fifo)) {
+                trace_ot_entropy_src_error("observe FIFO overflow",
+                                           STATE_NAME(s->state), s->state);
+                s->regs[R_FW_OV_RD_FIFO_OVERFLOW] |=
+                    R_FW_OV_RD_FIFO_OVERFLOW_VAL_MASK;
             } else {
-                trace_ot_entropy_src_info("observe FIFO not enabled");
+                if (s->obs_fifo_en) {
+                    unsigned threshold = s->regs[R_OBSERVE_FIFO_THRESH];
+                    ot_fifo32_push(&s->observe_fifo, word);
+                    trace_ot_entropy_src_obs_fifo(ot_fifo32_num_used(
+                                                      &s->observe_fifo),
+                                                  threshold);
+                    if (ot_fifo32_is_full(&s->observe_fifo)) {
+                        /* can only be enabled back once the FIFO is emptied */
+                        trace_ot_entropy_src_info("observe FIFO is full");
+                        s->obs_fifo_en = false;
+                    }
+                    /* is it > or >= ? */
+                    if (ot_fifo32_num_used(&s->observe_fifo) >= threshold) {
+                        s->regs[R_INTR_STATE] |=
+                            INTR_ES_OBSERVE_FIFO_READY_MASK;
+                    }
+                } else {
+                    trace_ot_entropy_src_info("observe FIFO not enabled");
+                }
             }
         }
-    }
 
-    if (hw_path) {
-        if (ot_entropy_src_is_bypass_mode(s)) {
-            ot_entropy_src_push_bypass_entropy(s, word);
-        } else {
-            if (ot_entropy_src_push_entropy_to_conditioner(s, word)) {
-                if (ot_entropy_src_can_hash(s)) {
-                    trace_ot_entropy_src_info("can hash");
-                    ot_entropy_src_perform_hash(s);
+        if (hw_path) {
+            if (bypass) {
+                ot_entropy_src_push_bypass_entropy(s, word);
+            } else {
+                if (ot_entropy_src_push_entropy_to_conditioner(s, word)) {
+                    if (ot_entropy_src_can_hash(s)) {
+                        trace_ot_entropy_src_info("can hash");
+                        ot_entropy_src_perform_hash(s);
+                    }
                 }
             }
         }
-    }
 
-    if (ot_entropy_src_is_fw_route(s)) {
-        ot_entropy_src_update_fw_route(s);
+        if (fw_route) {
+            ot_entropy_src_update_fw_route(s);
+        }
     }
 
-    return true;
+    s->noise_count += pos;
+    trace_ot_entropy_src_consume_entropy(fill_obs_fifo, bypass, hw_insert, pos,
+                                         s->noise_count);
+
+    return pos;
 }
 
 static bool ot_entropy_src_fill_noise(OtEntropySrcState *s)
@@ -1002,19 +1039,28 @@ static bool ot_entropy_src_fill_noise(OtEntropySrcState *s)
 
     uint32_t buffer[OT_ENTROPY_SRC_FILL_WORD_COUNT];
     /* synchronous read */
-    ot_ast_eg_getrandom(buffer, sizeof(buffer));
+    ot_ast_eg_getrandom(s->ast, buffer, sizeof(buffer));
 
     /* push the whole entropy buffer into the input FIFO */
-    unsigned pos = 0;
-    while (!ot_fifo32_is_full(&s->input_fifo) && pos < ES_WORD_COUNT) {
-        ot_fifo32_push(&s->input_fifo, buffer[pos++]);
+    for (unsigned pos = 0; pos < OT_ENTROPY_SRC_FILL_WORD_COUNT; pos++) {
+        ot_fifo32_push(&s->input_fifo, buffer[pos]);
     }
 
     trace_ot_entropy_src_fill_noise(count, ot_fifo32_num_used(&s->input_fifo));
 
-    for (unsigned ix = 0;
-         ix < ES_WORD_COUNT && !ot_fifo32_is_empty(&s->input_fifo); ix++) {
-        if (!ot_entropy_src_consume_entropy(s, ot_fifo32_pop(&s->input_fifo))) {
+    /* consume the input FIFO as contiguous windows rather than word-wise */
+    unsigned budget = ES_WORD_COUNT;
+    while (budget && !ot_fifo32_is_empty(&s->input_fifo)) {
+        uint32_t size;
+        const uint32_t *words;
+        words = ot_fifo32_peek_buf(&s->input_fifo,
+                                   MIN(budget, ot_fifo32_num_used(
+                                                   &s->input_fifo)),
+                                   &size);
+        unsigned done = ot_entropy_src_consume_entropy(s, words, size);
+        ot_fifo32_consume_all(&s->input_fifo, done);
+        budget -= done;
+        if (done < size) {
             break;
         }
     }
@@ -1242,7 +1288,7 @@ ot_entropy_src_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_ENTROPY_SRC_IO_READ_OUT);
     trace_ot_entropy_src_io_read_out((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     return (uint64_t)val32;
@@ -1269,7 +1315,7 @@ static void ot_entropy_src_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_ENTROPY_SRC_IO_WRITE);
     trace_ot_entropy_src_io_write((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -1416,7 +1462,7 @@ static void ot_entropy_src_regs_write(void *opaque, hwaddr addr, uint64_t val64,
         } else { /* default to false */
             if (s->state == ENTROPY_SRC_SHA3_PROCESS) {
                 /* handle SHA3 processing */
-                if (ot_fifo32_is_empty(&s->precon_fifo)) {
+                if (ot_entropy_src_is_packer_empty(s)) {
                     ot_entropy_src_perform_hash(s);
                     if (ot_entropy_src_is_fw_route(s)) {
                         ot_entropy_src_update_fw_route(s);
@@ -1626,7 +1672,7 @@ static void ot_entropy_src_init(Object *obj)
     }
 
     ot_fifo32_create(&s->input_fifo, OT_ENTROPY_SRC_FILL_WORD_COUNT * 2u);
-    ot_fifo32_create(&s->precon_fifo, sizeof(uint64_t) / sizeof(uint32_t));
+    ot_fifo32_create(&s->precon_fifo, ES_PRECON_WORD_COUNT);
     ot_fifo32_create(&s->bypass_fifo, ES_WORD_COUNT);
     ot_fifo32_create(&s->observe_fifo, PARAM_OBSERVE_FIFO_DEPTH);
     ot_fifo32_create(&s->swread_fifo, ES_SWREAD_FIFO_WORD_COUNT);
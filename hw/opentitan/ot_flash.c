@@ -29,6 +29,7 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/error-report.h"
 #include "qemu/log.h"
 #include "qemu/memalign.h"
 #include "qemu/timer.h"
@@ -47,6 +48,7 @@
 #include "hw/riscv/ibex_irq.h"
 #include "hw/sysbus.h"
 #include "sysemu/block-backend.h"
+#include "sysemu/hostmem.h"
 #include "trace.h"
 
 /* set to use I/O to access the flash partition */
@@ -644,6 +646,7 @@ struct OtFlashState {
         MemoryRegion mem;
     } mmio;
     QEMUTimer *op_delay; /* simulated long lasting operation */
+    OtPollWatch poll; /* STATUS poll loop tracker */
     IbexIRQ irqs[PARAM_NUM_IRQS];
     IbexIRQ alerts[PARAM_NUM_ALERTS];
 
@@ -661,6 +664,9 @@ struct OtFlashState {
     OtFlashStorage flash;
 
     BlockBackend *blk; /* Flash backend */
+    HostMemoryBackend *memdev; /* Mapped flash backend, excl. w/ blk */
+    char *ot_id;
+    bool fast_poll; /* skip init delay on STATUS poll loop */
 };
 
 static void ot_flash_update_irqs(OtFlashState *s)
@@ -971,6 +977,9 @@ static uint64_t ot_flash_regs_read(void *opaque, hwaddr addr, unsigned size)
         val32 = s->regs[reg];
         break;
     case R_STATUS:
+        if (s->fast_poll) {
+            ot_common_poll_watch(&s->poll, s->ot_id, addr);
+        }
         val32 = FIELD_DP32(s->regs[reg], STATUS, RD_FULL,
                            (uint32_t)ot_fifo32_is_full(&s->rd_fifo));
         val32 = FIELD_DP32(val32, STATUS, RD_EMPTY,
@@ -1010,7 +1019,7 @@ static uint64_t ot_flash_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_FLASH_IO_READ_OUT);
     trace_ot_flash_io_read_out((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     return (uint64_t)val32;
@@ -1025,7 +1034,7 @@ static void ot_flash_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_FLASH_IO_WRITE);
     trace_ot_flash_io_write((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     if (ot_flash_is_disabled(s)) {
@@ -1331,7 +1340,7 @@ static uint64_t ot_flash_csrs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_FLASH_IO_READ_OUT);
     trace_ot_flash_io_read_out((uint32_t)addr, CSR_NAME(csr), val32, pc);
 
     return (uint64_t)val32;
@@ -1346,7 +1355,7 @@ static void ot_flash_csrs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr csr = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_FLASH_IO_WRITE);
     trace_ot_flash_io_write((uint32_t)addr, CSR_NAME(csr), val32, pc);
 
     if (ot_flash_is_disabled(s)) {
@@ -1436,7 +1445,11 @@ static void ot_flash_csrs_write(void *opaque, hwaddr addr, uint64_t val64,
 }
 
 static Property ot_flash_properties[] = {
+    DEFINE_PROP_STRING("ot_id", OtFlashState, ot_id),
     DEFINE_PROP_DRIVE("drive", OtFlashState, blk),
+    DEFINE_PROP_LINK("memdev", OtFlashState, memdev, TYPE_MEMORY_BACKEND,
+                     HostMemoryBackend *),
+    DEFINE_PROP_BOOL("fast-poll", OtFlashState, fast_poll, false),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -1570,6 +1583,53 @@ static const char *ot_flash_hexdump(const uint8_t *buf, size_t size)
 }
 #endif
 
+static int ot_flash_read_backend(OtFlashState *s, unsigned offset,
+                                 unsigned size, void *buf)
+{
+    if (s->memdev) {
+        MemoryRegion *mr = host_memory_backend_get_memory(s->memdev);
+        if ((uint64_t)offset + size > memory_region_size(mr)) {
+            return -EINVAL;
+        }
+        memcpy(buf, (uint8_t *)memory_region_get_ram_ptr(mr) + offset, size);
+        return 0;
+    }
+
+    // NOLINTNEXTLINE(clang-analyzer-optin.core.EnumCastOutOfRange)
+    return blk_pread(s->blk, (int64_t)offset, (int64_t)size, buf, 0);
+}
+
+static uint32_t *
+ot_flash_map_backend(OtFlashState *s, unsigned offset, unsigned size,
+                     Error **errp)
+{
+    /*
+     * The flash controller never writes back to its backend, so the host
+     * memory backend may be a private file mapping: pages are only read from
+     * the file when first accessed, and are shared among all QEMU instances
+     * that use the same flash image file until they are modified.
+     */
+    MemoryRegion *mr = host_memory_backend_get_memory(s->memdev);
+
+    if ((uint64_t)offset + size > memory_region_size(mr)) {
+        error_setg(errp, "flash memdev is too small for the flash storage");
+        return NULL;
+    }
+
+    /* storage is accessed with 64-bit words */
+    if (offset & (sizeof(uint64_t) - 1u)) {
+        error_setg(errp, "flash memdev storage offset 0x%x is not aligned",
+                   offset);
+        return NULL;
+    }
+
+    trace_ot_flash_memdev(
+        object_get_canonical_path_component(OBJECT(s->memdev)),
+        memory_region_size(mr));
+
+    return (uint32_t *)((uint8_t *)memory_region_get_ram_ptr(mr) + offset);
+}
+
 static void ot_flash_load(OtFlashState *s, Error **errp)
 {
     /*
@@ -1588,10 +1648,18 @@ static void ot_flash_load(OtFlashState *s, Error **errp)
 
     memset(flash->info_parts, 0, sizeof(flash->info_parts));
 
-    if (s->blk) {
-        uint64_t perm = BLK_PERM_CONSISTENT_READ |
-                        (blk_supports_write_perm(s->blk) ? BLK_PERM_WRITE : 0);
-        (void)blk_set_perm(s->blk, perm, perm, errp);
+    if (s->blk && s->memdev) {
+        error_setg(errp, "flash drive and memdev are mutually exclusive");
+        return;
+    }
+
+    if (s->blk || s->memdev) {
+        if (s->blk) {
+            uint64_t perm =
+                BLK_PERM_CONSISTENT_READ |
+                (blk_supports_write_perm(s->blk) ? BLK_PERM_WRITE : 0);
+            (void)blk_set_perm(s->blk, perm, perm, errp);
+        }
 
         static_assert(sizeof(OtFlashBackendHeader) == 32u,
                       "Invalid backend header size");
@@ -1600,8 +1668,7 @@ static void ot_flash_load(OtFlashState *s, Error **errp)
             blk_blockalign(s->blk, sizeof(OtFlashBackendHeader));
 
         int rc;
-        // NOLINTNEXTLINE(clang-analyzer-optin.core.EnumCastOutOfRange)
-        rc = blk_pread(s->blk, 0, sizeof(*header), header, 0);
+        rc = ot_flash_read_backend(s, 0, sizeof(*header), header);
         if (rc < 0) {
             error_setg(errp, "failed to read the flash header content: %d", rc);
             return;
@@ -1647,21 +1714,30 @@ static void ot_flash_load(OtFlashState *s, Error **errp)
 
         g_assert(pg_offset == info_size);
 
-        flash->storage = blk_blockalign(s->blk, flash_size);
-        base = (uintptr_t)flash->storage;
-        g_assert(!(base & (sizeof(uint64_t) - 1u)));
-
         unsigned offset = offsetof(OtFlashBackendHeader, hlength) +
                           sizeof(header->hlength) + header->hlength;
 
-        // NOLINTNEXTLINE(clang-analyzer-optin.core.EnumCastOutOfRange)
-        rc = blk_pread(s->blk, (int64_t)offset, flash_size, flash->storage, 0);
-        if (rc < 0) {
-            error_setg(errp, "failed to read the initial flash content: %d",
-                       rc);
-            return;
+        if (s->memdev) {
+            flash->storage = ot_flash_map_backend(s, offset, flash_size, errp);
+            if (!flash->storage) {
+                return;
+            }
+        } else {
+            flash->storage = blk_blockalign(s->blk, flash_size);
+
+            // NOLINTNEXTLINE(clang-analyzer-optin.core.EnumCastOutOfRange)
+            rc = blk_pread(s->blk, (int64_t)offset, flash_size, flash->storage,
+                           0);
+            if (rc < 0) {
+                error_setg(errp, "failed to read the initial flash content: %d",
+                           rc);
+                return;
+            }
         }
 
+        base = (uintptr_t)flash->storage;
+        g_assert(!(base & (sizeof(uint64_t) - 1u)));
+
         flash->bank_count = header->bank;
         flash->size = flash_size;
 
@@ -1669,10 +1745,8 @@ static void ot_flash_load(OtFlashState *s, Error **errp)
         size_t debug_trailer_size =
             (size_t)(flash->bank_count) * ELFNAME_SIZE * BIN_APP_COUNT;
         uint8_t *elfnames = blk_blockalign(s->blk, debug_trailer_size);
-        // NOLINTBEGIN(clang-analyzer-optin.core.EnumCastOutOfRange)
-        rc = blk_pread(s->blk, (int64_t)offset + flash_size,
-                       (int64_t)debug_trailer_size, elfnames, 0);
-        // NOLINTEND(clang-analyzer-optin.core.EnumCastOutOfRange)
+        rc = ot_flash_read_backend(s, offset + flash_size,
+                                   (unsigned)debug_trailer_size, elfnames);
         if (!rc) {
             const char *elfname = (const char *)elfnames;
             for (unsigned ix = 0; ix < BIN_APP_COUNT; ix++) {
@@ -1787,7 +1861,20 @@ static const MemoryRegionOps ot_flash_mem_ops = {
 static void ot_flash_realize(DeviceState *dev, Error **errp)
 {
     OtFlashState *s = OT_FLASH(dev);
-    (void)errp;
+
+    if (!s->ot_id) {
+        s->ot_id =
+            g_strdup(object_get_canonical_path_component(OBJECT(s)->parent));
+    }
+
+    if (s->memdev) {
+        if (host_memory_backend_is_mapped(s->memdev)) {
+            error_setg(errp, "can't use already busy memdev: %s",
+                       object_get_canonical_path_component(OBJECT(s->memdev)));
+            return;
+        }
+        host_memory_backend_set_mapped(s->memdev, true);
+    }
 
     ot_flash_load(s, &error_fatal);
 
@@ -1807,6 +1894,21 @@ static void ot_flash_realize(DeviceState *dev, Error **errp)
     sysbus_init_mmio(SYS_BUS_DEVICE(s), mr);
 }
 
+static void ot_flash_unrealize(DeviceState *dev)
+{
+    OtFlashState *s = OT_FLASH(dev);
+
+    /* mapped storage belongs to the host memory backend */
+    if (s->memdev) {
+        host_memory_backend_set_mapped(s->memdev, false);
+    } else if (s->blk) {
+        qemu_vfree(s->flash.storage);
+    } else {
+        g_free(s->flash.storage);
+    }
+    s->flash.storage = NULL;
+}
+
 static void ot_flash_init(Object *obj)
 {
     OtFlashState *s = OT_FLASH(obj);
@@ -1830,6 +1932,7 @@ static void ot_flash_init(Object *obj)
         ibex_qdev_init_irq(obj, &s->alerts[ix], OT_DEVICE_ALERT);
     }
     s->op_delay = timer_new_ns(OT_VIRTUAL_CLOCK, &ot_flash_op_signal, s);
+    ot_common_poll_watch_init(&s->poll, s->op_delay);
 }
 
 static void ot_flash_class_init(ObjectClass *klass, void *data)
@@ -1839,6 +1942,7 @@ static void ot_flash_class_init(ObjectClass *klass, void *data)
 
     dc->reset = &ot_flash_reset;
     dc->realize = &ot_flash_realize;
+    dc->unrealize = &ot_flash_unrealize;
     device_class_set_props(dc, ot_flash_properties);
     set_bit(DEVICE_CATEGORY_MISC, dc->categories);
 }
@@ -470,7 +470,7 @@ static uint64_t ot_gpio_dj_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_GPIO_IO_READ_OUT);
     if (s->log_en) {
         trace_ot_gpio_io_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg),
                                   val32, pc);
@@ -489,7 +489,7 @@ static void ot_gpio_dj_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_GPIO_IO_WRITE);
     trace_ot_gpio_io_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
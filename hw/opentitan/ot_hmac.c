@@ -240,9 +240,19 @@ static void ot_hmac_process_fifo(OtHMACState *s)
     trace_ot_hmac_debug(s->ot_id, __func__);
 
     if (!fifo8_is_empty(&s->input_fifo)) {
+        /*
+         * Feed the hash engine with the largest contiguous chunks the FIFO
+         * ring buffer can provide: at most two chunks are required if the
+         * FIFO content wraps around. This lets libtomcrypt compress whole
+         * 64-byte blocks straight from the FIFO storage rather than copying
+         * each byte into its internal buffer.
+         */
         while (!fifo8_is_empty(&s->input_fifo)) {
-            uint8_t value = fifo8_pop(&s->input_fifo);
-            sha256_process(&s->ctx->state, &value, 1);
+            uint32_t num;
+            const uint8_t *buf =
+                fifo8_pop_bufptr(&s->input_fifo,
+                                 fifo8_num_used(&s->input_fifo), &num);
+            sha256_process(&s->ctx->state, buf, num);
         }
 
         /* assert FIFO Empty IRQ */
@@ -348,7 +358,7 @@ static uint64_t ot_hmac_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_HMAC_IO_READ_OUT);
     trace_ot_hmac_io_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                               pc);
 
@@ -364,7 +374,7 @@ static void ot_hmac_regs_write(void *opaque, hwaddr addr, uint64_t value,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_HMAC_IO_WRITE);
     trace_ot_hmac_io_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -512,7 +522,7 @@ static void ot_hmac_fifo_write(void *opaque, hwaddr addr, uint64_t value,
 {
     OtHMACState *s = OT_HMAC(opaque);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_HMAC_FIFO_WRITE);
     trace_ot_hmac_fifo_write(s->ot_id, (uint32_t)addr, (uint32_t)value, size,
                              pc);
 
@@ -536,12 +546,10 @@ static void ot_hmac_fifo_write(void *opaque, hwaddr addr, uint64_t value,
 
     ibex_irq_set(&s->clkmgr, true);
 
-    for (unsigned i = 0; i < size; i++) {
-        uint8_t b = value;
-        g_assert(!fifo8_is_full(&s->input_fifo));
-        fifo8_push(&s->input_fifo, b);
-        value >>= 8u;
-    }
+    uint8_t buf[sizeof(uint32_t)];
+    stl_le_p(buf, (uint32_t)value);
+    g_assert(fifo8_num_free(&s->input_fifo) >= size);
+    fifo8_push_all(&s->input_fifo, buf, size);
 
     s->regs->msg_length += (uint64_t)size * 8u;
 
@@ -562,7 +562,7 @@ static uint64_t ot_i2c_dj_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint64_t pc = ibex_get_current_pc();
+    uint64_t pc = ibex_get_current_pc_if(TRACE_OT_I2C_IO_READ);
     trace_ot_i2c_io_read(s->ot_id, (unsigned)addr, REG_NAME(reg),
                          (uint64_t)val32, pc);
 
@@ -684,7 +684,7 @@ static void ot_i2c_dj_write(void *opaque, hwaddr addr, uint64_t val64,
     OtI2CDjState *s = opaque;
     uint32_t val32 = val64;
     hwaddr reg = R32_OFF(addr);
-    uint64_t pc = ibex_get_current_pc();
+    uint64_t pc = ibex_get_current_pc_if(TRACE_OT_I2C_IO_WRITE);
     uint8_t address, mask;
     (void)size;
 
@@ -818,7 +818,7 @@ ot_ibex_wrapper_eg_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_IBEX_WRAPPER_IO_READ_OUT);
     trace_ot_ibex_wrapper_io_read_out(s->ot_id, addr, REG_NAME(reg), val32, pc);
 
     return (uint64_t)val32;
@@ -833,7 +833,7 @@ static void ot_ibex_wrapper_eg_regs_write(void *opaque, hwaddr addr,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_IBEX_WRAPPER_IO_WRITE);
     trace_ot_ibex_wrapper_io_write(s->ot_id, addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -623,9 +623,13 @@ static void ot_kmac_process(void *opaque)
     } else {
         /* SW mode, process FIFO data */
         if (!fifo8_is_empty(&s->input_fifo)) {
+            /* absorb FIFO content as contiguous chunks (two when wrapped) */
             while (!fifo8_is_empty(&s->input_fifo)) {
-                uint8_t value = fifo8_pop(&s->input_fifo);
-                sha3_process(&s->ltc_state, &value, 1);
+                uint32_t num;
+                const uint8_t *buf =
+                    fifo8_pop_bufptr(&s->input_fifo,
+                                     fifo8_num_used(&s->input_fifo), &num);
+                sha3_process(&s->ltc_state, buf, num);
             }
 
             /* assert FIFO Empty interrupt */
@@ -1144,7 +1148,7 @@ static uint64_t ot_kmac_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_KMAC_IO_READ_OUT);
     trace_ot_kmac_io_read_out((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     return (uint64_t)val32;
@@ -1159,7 +1163,7 @@ static void ot_kmac_regs_write(void *opaque, hwaddr addr, uint64_t value,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_KMAC_IO_WRITE);
     trace_ot_kmac_io_write((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -1385,7 +1389,7 @@ static uint64_t ot_kmac_state_read(void *opaque, hwaddr addr, unsigned size)
         }
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_KMAC_STATE_READ_OUT);
     trace_ot_kmac_state_read_out((uint32_t)addr, val32, pc);
 
     return (uint64_t)val32;
@@ -1417,7 +1421,7 @@ static void ot_kmac_msgfifo_write(void *opaque, hwaddr addr, uint64_t value,
 {
     OtKMACState *s = OT_KMAC(opaque);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_KMAC_MSGFIFO_WRITE);
     trace_ot_kmac_msgfifo_write((uint32_t)addr, (uint32_t)value, size, pc);
 
     /* trigger error if an app is running of not in MSG_FEED state */
@@ -1440,11 +1444,14 @@ static void ot_kmac_msgfifo_write(void *opaque, hwaddr addr, uint64_t value,
         ot_kmac_process(s);
     }
 
+    /* MMIO accesses are at most 32-bit wide */
+    uint8_t buf[sizeof(uint32_t)];
+    g_assert(size <= sizeof(buf));
     for (unsigned ix = 0; ix < size; ix++) {
         size_t byteoffset = byteswap ? (size - 1u - ix) : ix;
-        uint8_t b = (uint8_t)(value >> (byteoffset * 8u));
-        fifo8_push(&s->input_fifo, b);
+        buf[ix] = (uint8_t)(value >> (byteoffset * 8u));
     }
+    fifo8_push_all(&s->input_fifo, buf, size);
 
     /* trigger delayed processing of FIFO */
     ot_kmac_trigger_deferred_bh(s);
@@ -1728,7 +1728,7 @@ static uint32_t ot_lc_ctrl_regs_read(OtLcCtrlState *s, hwaddr addr,
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_LC_CTRL_IO_READ_OUT);
     if (reg != R_STATUS) {
         trace_ot_lc_ctrl_io_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg),
                                      val32, pc);
@@ -1765,7 +1765,7 @@ static void ot_lc_ctrl_regs_write(OtLcCtrlState *s, hwaddr addr, uint32_t val32,
 {
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_LC_CTRL_IO_WRITE);
     trace_ot_lc_ctrl_io_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                               pc);
 
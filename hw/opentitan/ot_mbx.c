@@ -329,7 +329,7 @@ static uint64_t ot_mbx_host_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_MBX_HOST_IO_READ_OUT);
     trace_ot_mbx_host_io_read_out(s->ot_id, (uint32_t)addr, REG_NAME(HOST, reg),
                                   val32, pc);
 
@@ -347,7 +347,7 @@ static void ot_mbx_host_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_MBX_HOST_IO_WRITE);
     trace_ot_mbx_host_io_write(s->ot_id, (uint32_t)addr, REG_NAME(HOST, reg),
                                val32, pc);
     switch (reg) {
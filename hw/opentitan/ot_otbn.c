@@ -403,7 +403,7 @@ static uint64_t ot_otbn_regs_read(void *opaque, hwaddr addr, unsigned size)
     (void)size;
     uint32_t val32;
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_OTBN_IO_READ_OUT);
 
     hwaddr reg = R32_OFF(addr);
     switch (reg) {
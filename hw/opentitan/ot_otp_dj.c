@@ -27,8 +27,12 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/bitmap.h"
 #include "qemu/bswap.h"
+#include "qemu/guest-random.h"
+#include "qemu/iov.h"
 #include "qemu/log.h"
+#include "qemu/memalign.h"
 #include "qemu/timer.h"
 #include "qemu/typedefs.h"
 #include "qapi/error.h"
@@ -49,6 +53,7 @@
 #include "hw/riscv/ibex_irq.h"
 #include "hw/sysbus.h"
 #include "sysemu/block-backend.h"
+#include "sysemu/runstate.h"
 #include "trace.h"
 
 #undef OT_OTP_DEBUG
@@ -65,6 +70,11 @@
 #define NUM_PART_BUF            7u
 #define OTP_BYTE_ADDR_WIDTH     14u
 
+/* granule of backend write-back tracking, in bytes */
+#define OTP_WB_GRANULE 64u
+/* delay for coalescing backend updates, in milliseconds */
+#define OTP_WB_DELAY_MS 20u
+
 /* clang-format off */
 /* Core registers */
 REG32(INTR_STATE, 0x0u)
@@ -731,6 +741,7 @@ typedef struct {
 
 typedef struct {
     QEMUTimer *delay; /* simulate delayed access completion */
+    OtPollWatch poll; /* STATUS poll loop tracker */
     QEMUBH *digest_bh; /* write computed digest to OTP cell */
     OtOTPDAIState state;
     int partition; /* current partition being worked on or -1 */
@@ -758,6 +769,23 @@ typedef struct {
     unsigned ecc_granule; /* size of a granule in bytes */
 } OtOTPStorage;
 
+typedef struct {
+    unsigned long *dirty; /* granules updated but not yet written back */
+    unsigned granule_count; /* count of granules in storage */
+    unsigned pending; /* count of in-flight asynchronous writes */
+    bool error; /* a write has failed and has not been recovered yet */
+    QEMUTimer *delay; /* coalescing delay before asynchronous write-back */
+    VMChangeStateEntry *vmse; /* write back on VM stop */
+} OtOTPWriteBack;
+
+typedef struct {
+    OtOTPDjState *s;
+    QEMUIOVector qiov;
+    void *buffer; /* snapshot of the storage content being written */
+    unsigned first; /* first granule */
+    unsigned count; /* count of granules */
+} OtOTPWriteBackReq;
+
 typedef struct {
     QEMUBH *bh;
     uint16_t signal; /* each bit tells if signal needs to be handled */
@@ -810,6 +838,7 @@ struct OtOTPDjState {
     uint8_t sram_const[16u];
 
     OtOTPStorage *otp;
+    OtOTPWriteBack *wb;
     OtOTPHWCfg *hw_cfg;
     OtOTPTokens *tokens;
 
@@ -823,6 +852,7 @@ struct OtOTPDjState {
     char *sram_const_xstr;
     char *sram_iv_xstr;
     uint8_t edn_ep;
+    bool fast_poll; /* shorten DAI delay on STATUS poll loop */
 };
 
 #define REG_NAME_ENTRY(_reg_) [R_##_reg_] = stringify(_reg_)
@@ -1800,8 +1830,8 @@ static bool ot_otp_dj_is_backend_writable(OtOTPDjState *s)
     return (s->blk != NULL) && blk_is_writable(s->blk);
 }
 
-static inline int ot_otp_dj_write_backend(OtOTPDjState *s, const void *buffer,
-                                          unsigned offset, size_t size)
+static inline int ot_otp_dj_pwrite_backend(OtOTPDjState *s, const void *buffer,
+                                           unsigned offset, size_t size)
 {
     /*
      * the blk_pwrite API is awful, isolate it so that linter exceptions are
@@ -1814,6 +1844,177 @@ static inline int ot_otp_dj_write_backend(OtOTPDjState *s, const void *buffer,
     // NOLINTEND(clang-analyzer-optin.core.EnumCastOutOfRange)
 }
 
+static void ot_otp_dj_wb_complete(void *opaque, int ret)
+{
+    OtOTPWriteBackReq *req = opaque;
+    OtOTPDjState *s = req->s;
+    OtOTPWriteBack *wb = s->wb;
+
+    if (ret < 0) {
+        /* report once until the backend has been successfully updated */
+        if (!wb->error) {
+            error_report("%s: %s: cannot update OTP backend: %s", __func__,
+                         s->ot_id, strerror(-ret));
+        }
+        /* retry on next write-back or sync point */
+        bitmap_set(wb->dirty, req->first, req->count);
+        wb->error = true;
+    }
+
+    trace_ot_otp_wb_complete(s->ot_id, req->first * OTP_WB_GRANULE,
+                             (unsigned)req->qiov.size, ret);
+
+    g_assert(wb->pending);
+    wb->pending -= 1u;
+
+    qemu_iovec_destroy(&req->qiov);
+    qemu_vfree(req->buffer);
+    g_free(req);
+}
+
+static void ot_otp_dj_wb_flush_async(void *opaque)
+{
+    OtOTPDjState *s = opaque;
+    OtOTPWriteBack *wb = s->wb;
+    unsigned count = wb->granule_count;
+
+    /*
+     * the block layer does not order concurrent requests: an older snapshot
+     * of a granule could land after a newer one. Wait for the in-flight
+     * writes to complete before issuing new ones.
+     */
+    if (wb->pending) {
+        timer_mod(wb->delay,
+                  qemu_clock_get_ms(QEMU_CLOCK_REALTIME) + OTP_WB_DELAY_MS);
+        return;
+    }
+
+    unsigned first = find_first_bit(wb->dirty, count);
+    while (first < count) {
+        unsigned last = find_next_zero_bit(wb->dirty, count, first);
+        unsigned offset = first * OTP_WB_GRANULE;
+        unsigned size = MIN((last - first) * OTP_WB_GRANULE,
+                            s->otp->size - offset);
+
+        bitmap_clear(wb->dirty, first, last - first);
+
+        /*
+         * the storage may be updated while the request is in flight, write a
+         * snapshot of the current content: any later update marks the granule
+         * as dirty again.
+         */
+        OtOTPWriteBackReq *req = g_new0(OtOTPWriteBackReq, 1u);
+        req->s = s;
+        req->first = first;
+        req->count = last - first;
+        req->buffer = blk_blockalign(s->blk, size);
+        memcpy(req->buffer, &((const uint8_t *)s->otp->storage)[offset], size);
+        qemu_iovec_init_buf(&req->qiov, req->buffer, size);
+
+        trace_ot_otp_wb_write(s->ot_id, offset, size);
+
+        wb->pending += 1u;
+        blk_aio_pwritev(s->blk, (int64_t)offset, &req->qiov, 0,
+                        &ot_otp_dj_wb_complete, req);
+
+        first = find_next_bit(wb->dirty, count, last);
+    }
+}
+
+/*
+ * Write back all pending updates to the backend and wait for completion.
+ * This should be called whenever OTP content should be durable.
+ */
+static int ot_otp_dj_wb_flush(OtOTPDjState *s)
+{
+    OtOTPWriteBack *wb = s->wb;
+
+    if (!ot_otp_dj_is_backend_writable(s)) {
+        return 0;
+    }
+
+    timer_del(wb->delay);
+
+    if (wb->pending) {
+        blk_drain(s->blk);
+        g_assert(!wb->pending);
+    }
+
+    int rc = 0;
+    unsigned count = wb->granule_count;
+    unsigned first = find_first_bit(wb->dirty, count);
+    while (first < count) {
+        unsigned last = find_next_zero_bit(wb->dirty, count, first);
+        unsigned offset = first * OTP_WB_GRANULE;
+        unsigned size = MIN((last - first) * OTP_WB_GRANULE,
+                            s->otp->size - offset);
+
+        trace_ot_otp_wb_write(s->ot_id, offset, size);
+
+        if (ot_otp_dj_pwrite_backend(
+                s, &((const uint8_t *)s->otp->storage)[offset], offset, size)) {
+            rc = -1;
+            break;
+        }
+        bitmap_clear(wb->dirty, first, last - first);
+
+        first = find_next_bit(wb->dirty, count, last);
+    }
+
+    if (!rc && blk_flush(s->blk)) {
+        rc = -1;
+    }
+
+    /*
+     * granules whose asynchronous write failed have been marked as dirty
+     * again, and have just been written back: the error only sticks if this
+     * synchronous retry has failed as well.
+     */
+    wb->error = rc != 0;
+
+    return rc;
+}
+
+static void ot_otp_dj_wb_vm_state_change(void *opaque, bool running,
+                                         RunState state)
+{
+    OtOTPDjState *s = opaque;
+    (void)state;
+
+    if (!running && ot_otp_dj_wb_flush(s)) {
+        error_report("%s: %s: cannot update OTP backend", __func__, s->ot_id);
+    }
+}
+
+static int ot_otp_dj_write_backend(OtOTPDjState *s, const void *buffer,
+                                   unsigned offset, size_t size)
+{
+    /*
+     * Backend updates are not written immediately: the updated range is
+     * tracked and written back asynchronously once no further update has
+     * occurred for a short period, so that bursts of DAI programming only
+     * lead to a few coalesced writes. Callers that require durability should
+     * call ot_otp_dj_wb_flush().
+     */
+    OtOTPWriteBack *wb = s->wb;
+
+    g_assert(buffer == &((const uint8_t *)s->otp->storage)[offset]);
+    g_assert(offset + size <= s->otp->size);
+
+    if (!size) {
+        return 0;
+    }
+
+    unsigned first = offset / OTP_WB_GRANULE;
+    unsigned last = (unsigned)((offset + size - 1u) / OTP_WB_GRANULE);
+    bitmap_set(wb->dirty, first, last - first + 1u);
+
+    timer_mod(wb->delay,
+              qemu_clock_get_ms(QEMU_CLOCK_REALTIME) + OTP_WB_DELAY_MS);
+
+    return 0;
+}
+
 static void ot_otp_dj_dai_init(OtOTPDjState *s)
 {
     DAI_CHANGE_STATE(s, OTP_DAI_IDLE);
@@ -2284,6 +2485,13 @@ static void ot_otp_dj_dai_write_digest(void *opaque)
         return;
     }
 
+    /* partition is now locked, ensure all its content is durable */
+    if (ot_otp_dj_wb_flush(s)) {
+        error_report("%s: cannot update OTP backend", __func__);
+        ot_otp_dj_dai_set_error(s, OTP_MACRO_ERROR);
+        return;
+    }
+
     trace_ot_otp_dai_new_digest_ecc(s->ot_id, PART_NAME(s->dai->partition),
                                     s->dai->partition, *dst, *edst);
 
@@ -2388,6 +2596,9 @@ static uint64_t ot_otp_dj_reg_read(void *opaque, hwaddr addr, unsigned size)
         val32 = s->regs[reg];
         break;
     case R_STATUS:
+        if (s->fast_poll) {
+            ot_common_poll_watch(&s->dai->poll, s->ot_id, addr);
+        }
         val32 = ot_otp_dj_get_status(s);
         break;
     case R_DIRECT_ACCESS_REGWEN:
@@ -2602,7 +2813,7 @@ static uint64_t ot_otp_dj_reg_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_OTP_IO_REG_READ_OUT);
     trace_ot_otp_io_reg_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                                  pc);
 
@@ -2618,7 +2829,7 @@ static void ot_otp_dj_reg_write(void *opaque, hwaddr addr, uint64_t value,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_OTP_IO_REG_WRITE);
 
     trace_ot_otp_io_reg_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                               pc);
@@ -3030,7 +3241,7 @@ static MemTxResult ot_otp_dj_swcfg_read_with_attrs(
 
     uint64_t pc;
 
-    pc = ibex_get_current_pc();
+    pc = ibex_get_current_pc_if(TRACE_OT_OTP_IO_SWCFG_READ_OUT);
     trace_ot_otp_io_swcfg_read_out(s->ot_id, (uint32_t)addr,
                                    ot_otp_dj_swcfg_reg_name(reg), val32, pc);
 
@@ -3365,7 +3576,7 @@ static void ot_otp_dj_lci_write_complete(OtOTPDjState *s, bool success)
         }
         if (ot_otp_dj_is_ecc_enabled(s)) {
             offset = (uintptr_t)s->otp->ecc - (uintptr_t)s->otp->storage;
-            if (ot_otp_dj_write_backend(s, &((uint16_t *)&s->otp->ecc)[lc_off],
+            if (ot_otp_dj_write_backend(s, &((uint16_t *)s->otp->ecc)[lc_off],
                                         (unsigned)(offset +
                                                    (lcdesc->offset >> 1u)),
                                         lcdesc->size >> 1u)) {
@@ -3376,6 +3587,14 @@ static void ot_otp_dj_lci_write_complete(OtOTPDjState *s, bool success)
                 }
             }
         }
+        /* life cycle transitions should always be durable */
+        if (ot_otp_dj_wb_flush(s)) {
+            error_report("%s: cannot update OTP backend", __func__);
+            if (lci->error == OTP_NO_ERROR) {
+                lci->error = OTP_MACRO_ERROR;
+                LCI_CHANGE_STATE(s, OTP_LCI_ERROR);
+            }
+        }
     }
 
     g_assert(lci->ack_fn);
@@ -3774,6 +3993,15 @@ static void ot_otp_dj_load(OtOTPDjState *s)
 
     otp->data_size = data_size;
     otp->ecc_size = ecc_size;
+    otp->size = (unsigned)otp_size;
+
+    OtOTPWriteBack *wb = s->wb;
+    wb->granule_count = DIV_ROUND_UP(otp->size, OTP_WB_GRANULE);
+    wb->dirty = bitmap_new(wb->granule_count);
+    if (ot_otp_dj_is_backend_writable(s)) {
+        wb->vmse =
+            qemu_add_vm_change_state_handler(&ot_otp_dj_wb_vm_state_change, s);
+    }
 }
 
 static Property ot_otp_dj_properties[] = {
@@ -3788,6 +4016,7 @@ static Property ot_otp_dj_properties[] = {
     DEFINE_PROP_STRING("digest_iv", OtOTPDjState, digest_iv_xstr),
     DEFINE_PROP_STRING("sram_const", OtOTPDjState, sram_const_xstr),
     DEFINE_PROP_STRING("sram_iv", OtOTPDjState, sram_iv_xstr),
+    DEFINE_PROP_BOOL("fast-poll", OtOTPDjState, fast_poll, false),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -3937,6 +4166,7 @@ static void ot_otp_dj_init(Object *obj)
     s->partctrls = g_new0(OtOTPPartController, OTP_PART_COUNT);
     s->keygen = g_new0(OtOTPKeyGen, 1u);
     s->otp = g_new0(OtOTPStorage, 1u);
+    s->wb = g_new0(OtOTPWriteBack, 1u);
     s->scrmbl_key_init = g_new0(OtOTPScrmblKeyInit, 1u);
 
     for (unsigned ix = 0; ix < OTP_PART_COUNT; ix++) {
@@ -3952,6 +4182,7 @@ static void ot_otp_dj_init(Object *obj)
     s->keygen->prng = ot_prng_allocate();
 
     s->dai->delay = timer_new_ns(OT_VIRTUAL_CLOCK, &ot_otp_dj_dai_complete, s);
+    ot_common_poll_watch_init(&s->dai->poll, s->dai->delay);
     s->dai->digest_bh = qemu_bh_new(&ot_otp_dj_dai_write_digest, s);
     s->lci->prog_delay =
         timer_new_ns(OT_VIRTUAL_CLOCK, &ot_otp_dj_lci_write_word, s);
@@ -3959,9 +4190,12 @@ static void ot_otp_dj_init(Object *obj)
     s->pwr_otp_bh = qemu_bh_new(&ot_otp_dj_pwr_otp_bh, s);
     s->lc_broadcast.bh = qemu_bh_new(&ot_otp_dj_lc_broadcast_bh, s);
     s->keygen->entropy_bh = qemu_bh_new(&ot_otp_dj_request_entropy_bh, s);
+    s->wb->delay =
+        timer_new_ms(QEMU_CLOCK_REALTIME, &ot_otp_dj_wb_flush_async, s);
 
-    int64_t now = qemu_clock_get_ms(QEMU_CLOCK_REALTIME);
-    ot_prng_reseed(s->keygen->prng, (uint32_t)now);
+    uint32_t seed[8u];
+    qemu_guest_getrandom_nofail(seed, sizeof(seed));
+    ot_prng_reseed_array(s->keygen->prng, seed, ARRAY_SIZE(seed));
 }
 
 static void ot_otp_dj_class_init(ObjectClass *klass, void *data)
@@ -374,6 +374,7 @@ struct OtOTPEgState {
     IbexIRQ alerts[NUM_ALERTS];
 
     QEMUTimer *dai_delay; /**< Simulate delayed access completion */
+    OtPollWatch dai_poll; /**< STATUS poll loop tracker */
 
     uint32_t regs[REGS_COUNT];
     uint32_t alert_bm;
@@ -389,6 +390,7 @@ struct OtOTPEgState {
     OtOtpBeIf *otp_backend;
     OtEDNState *edn;
     uint8_t edn_ep;
+    bool fast_poll; /* complete DAI ops early on STATUS poll loop */
 };
 /* clang-format on */
 
@@ -667,6 +669,9 @@ static uint64_t ot_otp_eg_reg_read(void *opaque, hwaddr addr, unsigned size)
         val32 = s->regs[reg];
         break;
     case R_STATUS:
+        if (s->fast_poll) {
+            ot_common_poll_watch(&s->dai_poll, s->ot_id, addr);
+        }
         val32 = ot_otp_eg_get_status(s);
         break;
     case R_DIRECT_ACCESS_REGWEN:
@@ -762,7 +767,7 @@ static uint64_t ot_otp_eg_reg_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_OTP_IO_REG_READ_OUT);
     trace_ot_otp_io_reg_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                                  pc);
 
@@ -778,7 +783,7 @@ static void ot_otp_eg_reg_write(void *opaque, hwaddr addr, uint64_t value,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_OTP_IO_REG_WRITE);
     trace_ot_otp_io_reg_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                               pc);
 
@@ -978,7 +983,7 @@ static uint64_t ot_otp_eg_swcfg_read(void *opaque, hwaddr addr, unsigned size)
 
     uint64_t pc;
 
-    pc = ibex_get_current_pc();
+    pc = ibex_get_current_pc_if(TRACE_OT_OTP_IO_SWCFG_READ_OUT);
     trace_ot_otp_io_swcfg_read_out(s->ot_id, (uint32_t)addr,
                                    ot_otp_eg_swcfg_reg_name(reg), val32, pc);
 
@@ -1075,6 +1080,7 @@ static Property ot_otp_eg_properties[] = {
                      OtOtpBeIf *),
     DEFINE_PROP_LINK("edn", OtOTPEgState, edn, TYPE_OT_EDN, OtEDNState *),
     DEFINE_PROP_UINT8("edn-ep", OtOTPEgState, edn_ep, UINT8_MAX),
+    DEFINE_PROP_BOOL("fast-poll", OtOTPEgState, fast_poll, false),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -1250,6 +1256,7 @@ static void ot_otp_eg_init(Object *obj)
     s->hw_cfg = g_new0(OtOTPHWCfg, 1u);
     s->entropy_cfg = g_new0(OtOTPEntropyCfg, 1u);
     s->dai_delay = timer_new_ns(OT_VIRTUAL_CLOCK, &ot_otp_eg_complete_dai, s);
+    ot_common_poll_watch_init(&s->dai_poll, s->dai_delay);
 }
 
 static void ot_otp_eg_class_init(ObjectClass *klass, void *data)
@@ -149,7 +149,7 @@ static uint64_t ot_otp_ot_be_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_OTP_OT_BE_READ_OUT);
     trace_ot_otp_ot_be_read_out((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     return (uint64_t)val32;
@@ -164,7 +164,7 @@ static void ot_otp_ot_be_write(void *opaque, hwaddr addr, uint64_t value,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_OTP_OT_BE_WRITE);
     trace_ot_otp_ot_be_write((uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
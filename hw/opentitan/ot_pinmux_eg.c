@@ -294,7 +294,7 @@ static uint64_t ot_pinmux_eg_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_PINMUX_IO_READ_OUT);
     trace_ot_pinmux_io_read_out((uint32_t)addr, val32, pc);
 
     return (uint64_t)val32;
@@ -312,7 +312,7 @@ static void ot_pinmux_eg_regs_write(void *opaque, hwaddr addr, uint64_t val64,
     hwaddr reg = R32_OFF(addr);
     OtPinmuxEgStateRegs *regs = s->regs;
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_PINMUX_IO_WRITE);
     trace_ot_pinmux_io_write((uint32_t)addr, val32, pc);
 
     switch (reg) {
@@ -36,6 +36,7 @@
 #include "hw/registerfields.h"
 #include "hw/riscv/ibex_common.h"
 #include "hw/riscv/ibex_irq.h"
+#include "migration/vmstate.h"
 #include "trace.h"
 
 /* clang-format off */
@@ -98,7 +99,7 @@ static uint64_t ot_plic_ext_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_PLIC_EXT_IO_READ_OUT);
     trace_ot_plic_ext_io_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg),
                                   val32, pc);
 
@@ -114,7 +115,7 @@ static void ot_plic_ext_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_PLIC_EXT_IO_WRITE);
     trace_ot_plic_ext_io_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                                pc);
 
@@ -150,6 +151,18 @@ static const MemoryRegionOps ot_plic_ext_regs_ops = {
     .impl.max_access_size = 4u,
 };
 
+static const VMStateDescription vmstate_ot_plic_ext = {
+    .name = TYPE_OT_PLIC_EXT,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32_ARRAY(regs, OtPlicExtState, REGS_COUNT),
+        VMSTATE_IBEX_IRQ(irq, OtPlicExtState),
+        VMSTATE_IBEX_IRQ(alert, OtPlicExtState),
+        VMSTATE_END_OF_LIST(),
+    },
+};
+
 static void ot_plic_ext_reset(DeviceState *dev)
 {
     OtPlicExtState *s = OT_PLIC_EXT(dev);
@@ -189,6 +202,7 @@ static void ot_plic_ext_class_init(ObjectClass *klass, void *data)
 
     dc->reset = &ot_plic_ext_reset;
     dc->realize = &ot_plic_ext_realize;
+    dc->vmsd = &vmstate_ot_plic_ext;
     device_class_set_props(dc, ot_plic_ext_properties);
     set_bit(DEVICE_CATEGORY_MISC, dc->categories);
 }
@@ -25,57 +25,186 @@
  * THE SOFTWARE.
  */
 
+/*
+ * The generator is a ChaCha8 keystream: it is not meant to provide any
+ * cryptographic guarantee, but to deliver reproducible pseudo-random data in
+ * whole 64-byte blocks at a fraction of the cost of a host entropy request.
+ * Default seeds are drawn from the QEMU guest random generator, so the output
+ * of a generator only depends on the `-seed` option when QEMU is started with
+ * it, provided its user does not reseed it from another source.
+ */
+
 #include "qemu/osdep.h"
+#include "qemu/bitops.h"
+#include "qemu/guest-random.h"
 #include "qom/object.h"
 #include "hw/opentitan/ot_prng.h"
 
+#define OT_PRNG_KEY_WORDS   8u
+#define OT_PRNG_BLOCK_WORDS 16u
+#define OT_PRNG_DBL_ROUNDS  4u /* ChaCha8 */
+
 DECLARE_INSTANCE_CHECKER(OtPrngState, OT_PRNG, TYPE_OT_PRNG)
 
 struct OtPrngState {
-    GRand *rand;
+    uint32_t key[OT_PRNG_KEY_WORDS];
+    uint64_t counter; /* block counter */
+    uint64_t nonce;
+    uint32_t block[OT_PRNG_BLOCK_WORDS]; /* buffered keystream */
+    unsigned pos; /* next unused word in block */
+};
+
+/* "expand 32-byte k" */
+static const uint32_t OT_PRNG_SIGMA[4u] = {
+    0x61707865u, 0x3320646eu, 0x79622d32u, 0x6b206574u
 };
 
+#define OT_PRNG_QR(_a_, _b_, _c_, _d_) \
+    do { \
+        (_a_) += (_b_); \
+        (_d_) = rol32((_d_) ^ (_a_), 16); \
+        (_c_) += (_d_); \
+        (_b_) = rol32((_b_) ^ (_c_), 12); \
+        (_a_) += (_b_); \
+        (_d_) = rol32((_d_) ^ (_a_), 8); \
+        (_c_) += (_d_); \
+        (_b_) = rol32((_b_) ^ (_c_), 7); \
+    } while (0)
+
+static void ot_prng_generate(OtPrngState *prng, uint32_t *out)
+{
+    uint32_t in[OT_PRNG_BLOCK_WORDS];
+    uint32_t x[OT_PRNG_BLOCK_WORDS];
+
+    memcpy(&in[0], OT_PRNG_SIGMA, sizeof(OT_PRNG_SIGMA));
+    memcpy(&in[4u], prng->key, sizeof(prng->key));
+    in[12u] = (uint32_t)prng->counter;
+    in[13u] = (uint32_t)(prng->counter >> 32u);
+    in[14u] = (uint32_t)prng->nonce;
+    in[15u] = (uint32_t)(prng->nonce >> 32u);
+    prng->counter++;
+
+    memcpy(x, in, sizeof(in));
+    for (unsigned rd = 0; rd < OT_PRNG_DBL_ROUNDS; rd++) {
+        OT_PRNG_QR(x[0], x[4], x[8], x[12]);
+        OT_PRNG_QR(x[1], x[5], x[9], x[13]);
+        OT_PRNG_QR(x[2], x[6], x[10], x[14]);
+        OT_PRNG_QR(x[3], x[7], x[11], x[15]);
+        OT_PRNG_QR(x[0], x[5], x[10], x[15]);
+        OT_PRNG_QR(x[1], x[6], x[11], x[12]);
+        OT_PRNG_QR(x[2], x[7], x[8], x[13]);
+        OT_PRNG_QR(x[3], x[4], x[9], x[14]);
+    }
+
+    for (unsigned ix = 0; ix < OT_PRNG_BLOCK_WORDS; ix++) {
+        out[ix] = x[ix] + in[ix];
+    }
+}
+
+static void ot_prng_rekey(OtPrngState *prng, const uint32_t *seed,
+                          size_t length)
+{
+    uint32_t block[OT_PRNG_BLOCK_WORDS];
+
+    memset(prng->key, 0, sizeof(prng->key));
+    /* tell apart seeds that only differ by trailing zero words */
+    prng->nonce = (uint64_t)length;
+    prng->counter = 0;
+
+    /*
+     * Absorb the seed one key-sized chunk at a time: each chunk is mixed into
+     * the current key, which is then replaced with the first half of the
+     * keystream block it generates, so that every seed word contributes to
+     * the final key.
+     */
+    do {
+        size_t count = MIN(length, (size_t)OT_PRNG_KEY_WORDS);
+        for (size_t ix = 0; ix < count; ix++) {
+            prng->key[ix] ^= seed[ix];
+        }
+        ot_prng_generate(prng, block);
+        memcpy(prng->key, block, sizeof(prng->key));
+        seed += count;
+        length -= count;
+    } while (length);
+
+    prng->counter = 0;
+    prng->pos = OT_PRNG_BLOCK_WORDS;
+}
+
 OtPrngState *ot_prng_allocate(void)
 {
     OtPrngState *prng;
-    prng = g_new(OtPrngState, 1u);
-    prng->rand = g_rand_new();
+    uint32_t seed[OT_PRNG_KEY_WORDS];
+
+    prng = g_new0(OtPrngState, 1u);
+    qemu_guest_getrandom_nofail(seed, sizeof(seed));
+    ot_prng_rekey(prng, seed, OT_PRNG_KEY_WORDS);
     return prng;
 }
 
 void ot_prng_release(OtPrngState *prng)
 {
-    g_rand_free(prng->rand);
     g_free(prng);
 }
 
 uint32_t ot_prng_random_u32(OtPrngState *prng)
 {
-    return (uint32_t)g_rand_int(prng->rand);
+    if (prng->pos >= OT_PRNG_BLOCK_WORDS) {
+        ot_prng_generate(prng, prng->block);
+        prng->pos = 0;
+    }
+
+    return prng->block[prng->pos++];
 }
 
 void ot_prng_random_u32_array(OtPrngState *prng, uint32_t *array, size_t count)
 {
+    /* drain the buffered keystream first */
+    while (count && prng->pos < OT_PRNG_BLOCK_WORDS) {
+        *array++ = prng->block[prng->pos++];
+        count--;
+    }
+
+    /* then generate whole blocks in place */
+    while (count >= OT_PRNG_BLOCK_WORDS) {
+        ot_prng_generate(prng, array);
+        array += OT_PRNG_BLOCK_WORDS;
+        count -= OT_PRNG_BLOCK_WORDS;
+    }
+
     while (count--) {
-        *array++ = (uint32_t)g_rand_int(prng->rand);
+        *array++ = ot_prng_random_u32(prng);
     }
 }
 
-void ot_prng_reseed(OtPrngState *prng, uint32_t seed)
+void ot_prng_random_buffer(OtPrngState *prng, void *buf, size_t len)
 {
-    if (prng->rand) {
-        g_rand_free(prng->rand);
+    uint8_t *dst = buf;
+
+    if (QEMU_PTR_IS_ALIGNED(dst, sizeof(uint32_t))) {
+        size_t count = len / sizeof(uint32_t);
+        ot_prng_random_u32_array(prng, (uint32_t *)dst, count);
+        dst += count * sizeof(uint32_t);
+        len -= count * sizeof(uint32_t);
     }
 
-    prng->rand = g_rand_new_with_seed((guint32)seed);
+    while (len) {
+        uint32_t word = ot_prng_random_u32(prng);
+        size_t chunk = MIN(len, sizeof(uint32_t));
+        memcpy(dst, &word, chunk);
+        dst += chunk;
+        len -= chunk;
+    }
+}
+
+void ot_prng_reseed(OtPrngState *prng, uint32_t seed)
+{
+    ot_prng_rekey(prng, &seed, 1u);
 }
 
 void ot_prng_reseed_array(OtPrngState *prng, const uint32_t *seed,
                           size_t length)
 {
-    if (prng->rand) {
-        g_rand_free(prng->rand);
-    }
-
-    prng->rand = g_rand_new_with_seed_array((const guint32 *)seed, length);
+    ot_prng_rekey(prng, seed, length);
 }
@@ -38,7 +38,7 @@
 
 #include "qemu/osdep.h"
 #include "qemu/bswap.h"
-#include "qemu/fifo8.h"
+#include "qemu/error-report.h"
 #include "qemu/log.h"
 #include "qemu/memalign.h"
 #include "qapi/error.h"
@@ -117,6 +117,13 @@ static const char *REG_NAMES[REGS_COUNT] = {
 #define ROM_DIGEST_WORDS 8u
 #define ROM_DIGEST_BYTES (ROM_DIGEST_WORDS * sizeof(uint32_t))
 
+/* bump the version whenever the cache file layout or the decoding changes */
+#define OT_ROM_CTRL_CACHE_MAGIC   "OTROMC"
+#define OT_ROM_CTRL_CACHE_VERSION 2u
+
+/* size of the chunks the ROM image file is hashed by */
+#define OT_ROM_CTRL_CACHE_HASH_CHUNK 65536u
+
 /* clang-format off */
 static const uint8_t SBOX4[16u] = {
     12u, 5u, 6u, 11u, 9u, 0u, 10u, 13u, 3u, 14u, 15u, 8u, 4u, 7u, 1u, 2u
@@ -130,6 +137,17 @@ static const uint8_t SBOX4_INV[16u] = {
 static const OtKMACAppCfg KMAC_APP_CFG =
     OT_KMAC_CONFIG(CSHAKE, 256u, "", "ROM_CTRL");
 
+/* all multi-byte fields are stored little-endian */
+typedef struct QEMU_PACKED {
+    char magic[6u];
+    uint16_t version;
+    uint32_t size; /* size of the unscrambled ROM image that follows */
+    uint32_t recovered_error_count;
+    uint32_t unrecoverable_error_count;
+    uint32_t exp_digest[ROM_DIGEST_WORDS];
+    uint32_t digest[ROM_DIGEST_WORDS];
+} OtRomCtrlCacheHeader;
+
 struct OtRomCtrlClass {
     DeviceClass parent_class;
     DeviceRealize parent_realize;
@@ -147,7 +165,6 @@ struct OtRomCtrlState {
 
     uint32_t regs[REGS_COUNT];
 
-    Fifo8 hash_fifo;
     uint64_t keys[2u]; /* may be NULL */
     uint64_t nonce;
     uint64_t addr_nonce;
@@ -156,10 +173,11 @@ struct OtRomCtrlState {
     unsigned data_nonce_width; /* bit count */
     unsigned se_pos;
     unsigned se_last_pos;
-    uint64_t *se_buffer;
+    uint8_t *se_buffer; /* scrambled words w/ ECC, in logical address order */
     unsigned recovered_error_count;
     unsigned unrecoverable_error_count;
     bool first_reset;
+    char *cache_path; /* cache file for the current ROM image, if any */
 
     char *ot_id;
     uint32_t size;
@@ -167,6 +185,7 @@ struct OtRomCtrlState {
     uint8_t kmac_app;
     char *nonce_xstr;
     char *key_xstr;
+    char *cache_dir;
 };
 
 static void ot_rom_ctrl_get_mem_bounds(OtRomCtrlState *s, hwaddr *minaddr,
@@ -343,38 +362,151 @@ static void ot_rom_ctrl_compare_and_notify(OtRomCtrlState *s)
     ibex_irq_set(&s->pwrmgr_done, true);
 }
 
-static void ot_rom_ctrl_send_kmac_req(OtRomCtrlState *s)
+static char *ot_rom_ctrl_cache_get_path(OtRomCtrlState *s, const OtRomImg *ri)
 {
-    g_assert(s->se_buffer);
-    fifo8_reset(&s->hash_fifo);
-
-    while (!fifo8_is_full(&s->hash_fifo) && (s->se_pos < s->se_last_pos)) {
-        unsigned word_pos = s->se_pos / OT_ROM_CTRL_WORD_BYTES;
-        unsigned word_off = s->se_pos % OT_ROM_CTRL_WORD_BYTES;
-        unsigned phy_addr = ot_rom_ctrl_addr_sp_enc(s, word_pos);
-        uint8_t wbuf[sizeof(uint64_t)];
-        stq_le_p(wbuf, s->se_buffer[phy_addr]);
-        uint8_t *wb = wbuf;
-        unsigned wl = OT_ROM_CTRL_WORD_BYTES;
-        wb += word_off;
-        wl -= word_off;
-        wl = MIN(wl, fifo8_num_free(&s->hash_fifo));
-        s->se_pos += wl;
-        while (wl--) {
-            fifo8_push(&s->hash_fifo, *wb++);
+    Error *err = NULL;
+
+    int fd = qemu_open(ri->filename, O_RDONLY | O_BINARY, &err);
+    if (fd < 0) {
+        trace_ot_rom_ctrl_cache(s->ot_id, "unreadable",
+                                error_get_pretty(err));
+        error_free(err);
+        return NULL;
+    }
+
+    /*
+     * The decoded image depends on the image file content, on the
+     * unscrambling constants and on the ROM size: all of them are part of
+     * the cache key.
+     */
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    uint32_t meta[2u] = { cpu_to_le32(OT_ROM_CTRL_CACHE_VERSION),
+                          cpu_to_le32(s->size) };
+    g_checksum_update(checksum, (const guchar *)meta, sizeof(meta));
+    g_checksum_update(checksum, (const guchar *)s->key_xstr, -1);
+    g_checksum_update(checksum, (const guchar *)s->nonce_xstr, -1);
+
+    /* hash the image by chunks rather than loading it as a whole */
+    guchar *chunk = g_malloc(OT_ROM_CTRL_CACHE_HASH_CHUNK);
+    ssize_t len;
+    do {
+        len = RETRY_ON_EINTR(read(fd, chunk, OT_ROM_CTRL_CACHE_HASH_CHUNK));
+        if (len > 0) {
+            g_checksum_update(checksum, chunk, len);
         }
+    } while (len > 0);
+    g_free(chunk);
+    qemu_close(fd);
+
+    if (len < 0) {
+        trace_ot_rom_ctrl_cache(s->ot_id, "unreadable", ri->filename);
+        g_checksum_free(checksum);
+        return NULL;
+    }
+
+    char *name =
+        g_strdup_printf("ot_rom_%s.bin", g_checksum_get_string(checksum));
+    char *path = g_build_filename(s->cache_dir, name, NULL);
+    g_checksum_free(checksum);
+    g_free(name);
+
+    return path;
+}
+
+static bool ot_rom_ctrl_cache_load(OtRomCtrlState *s)
+{
+    GMappedFile *mfile = g_mapped_file_new(s->cache_path, FALSE, NULL);
+    if (!mfile) {
+        trace_ot_rom_ctrl_cache(s->ot_id, "miss", s->cache_path);
+        return false;
+    }
+
+    const char *content = g_mapped_file_get_contents(mfile);
+    gsize length = g_mapped_file_get_length(mfile);
+
+    const OtRomCtrlCacheHeader *hdr = (const OtRomCtrlCacheHeader *)content;
+    if (length != sizeof(*hdr) + s->size ||
+        memcmp(hdr->magic, OT_ROM_CTRL_CACHE_MAGIC, sizeof(hdr->magic)) ||
+        le16_to_cpu(hdr->version) != OT_ROM_CTRL_CACHE_VERSION ||
+        le32_to_cpu(hdr->size) != s->size) {
+        trace_ot_rom_ctrl_cache(s->ot_id, "invalid", s->cache_path);
+        g_mapped_file_unref(mfile);
+        return false;
+    }
+
+    /* the ROM storage belongs to the memory region: copy from the mapping */
+    uint8_t *rom_ptr = (uint8_t *)memory_region_get_ram_ptr(&s->mem);
+    memcpy(rom_ptr, &content[sizeof(*hdr)], s->size);
+    memory_region_set_dirty(&s->mem, 0, s->size);
+
+    s->recovered_error_count = le32_to_cpu(hdr->recovered_error_count);
+    s->unrecoverable_error_count = le32_to_cpu(hdr->unrecoverable_error_count);
+    for (unsigned ix = 0; ix < ROM_DIGEST_WORDS; ix++) {
+        s->regs[R_EXP_DIGEST_0 + ix] = le32_to_cpu(hdr->exp_digest[ix]);
+        s->regs[R_DIGEST_0 + ix] = le32_to_cpu(hdr->digest[ix]);
     }
+    g_mapped_file_unref(mfile);
+
+    /* see ot_rom_ctrl_handle_kmac_response */
+    memory_region_rom_device_set_romd(&s->mem,
+                                      s->unrecoverable_error_count == 0);
 
-    g_assert(!fifo8_is_empty(&s->hash_fifo));
+    trace_ot_rom_ctrl_cache(s->ot_id, "hit", s->cache_path);
+    trace_ot_rom_ctrl_digest_mode(s->ot_id, "cached");
+
+    return true;
+}
+
+static void ot_rom_ctrl_cache_store(OtRomCtrlState *s)
+{
+    if (!s->cache_path) {
+        return;
+    }
+
+    gsize length = sizeof(OtRomCtrlCacheHeader) + s->size;
+    char *content = g_malloc0(length);
+    OtRomCtrlCacheHeader *hdr = (OtRomCtrlCacheHeader *)content;
+
+    memcpy(hdr->magic, OT_ROM_CTRL_CACHE_MAGIC, sizeof(hdr->magic));
+    hdr->version = cpu_to_le16(OT_ROM_CTRL_CACHE_VERSION);
+    hdr->size = cpu_to_le32(s->size);
+    hdr->recovered_error_count = cpu_to_le32(s->recovered_error_count);
+    hdr->unrecoverable_error_count = cpu_to_le32(s->unrecoverable_error_count);
+    for (unsigned ix = 0; ix < ROM_DIGEST_WORDS; ix++) {
+        hdr->exp_digest[ix] = cpu_to_le32(s->regs[R_EXP_DIGEST_0 + ix]);
+        hdr->digest[ix] = cpu_to_le32(s->regs[R_DIGEST_0 + ix]);
+    }
+    memcpy(&content[sizeof(*hdr)], memory_region_get_ram_ptr(&s->mem),
+           s->size);
+
+    /* file is written to a temporary file then atomically renamed */
+    GError *gerr = NULL;
+    if (g_file_set_contents(s->cache_path, content, (gssize)length, &gerr)) {
+        trace_ot_rom_ctrl_cache(s->ot_id, "store", s->cache_path);
+    } else {
+        warn_report("%s: %s: cannot store ROM cache: %s", __func__, s->ot_id,
+                    gerr->message);
+        g_error_free(gerr);
+    }
+
+    g_free(content);
+    g_free(s->cache_path);
+    s->cache_path = NULL;
+}
+
+static void ot_rom_ctrl_send_kmac_req(OtRomCtrlState *s)
+{
+    g_assert(s->se_buffer);
+    g_assert(s->se_pos < s->se_last_pos);
+
+    unsigned len = MIN(s->se_last_pos - s->se_pos, OT_KMAC_APP_MSG_BYTES);
 
     OtKMACAppReq req = {
-        .last = s->se_pos == s->se_last_pos,
-        .msg_len = fifo8_num_used(&s->hash_fifo),
+        .msg_len = len,
     };
-    uint32_t blen;
-    const uint8_t *buf = fifo8_pop_bufptr(&s->hash_fifo, req.msg_len, &blen);
-    g_assert(blen == req.msg_len);
-    memcpy(req.msg_data, buf, req.msg_len);
+    memcpy(req.msg_data, &s->se_buffer[s->se_pos], len);
+    s->se_pos += len;
+    req.last = s->se_pos == s->se_last_pos;
 
     ot_kmac_app_request(s->kmac, s->kmac_app, &req);
 }
@@ -390,7 +522,7 @@ ot_rom_ctrl_handle_kmac_response(void *opaque, const OtKMACAppRsp *rsp)
     }
 
     g_assert(s->se_buffer);
-    qemu_vfree(s->se_buffer);
+    g_free(s->se_buffer);
     s->se_buffer = NULL;
 
     g_assert(s->se_pos == s->se_last_pos);
@@ -417,6 +549,8 @@ ot_rom_ctrl_handle_kmac_response(void *opaque, const OtKMACAppRsp *rsp)
 
     trace_ot_rom_ctrl_digest_mode(s->ot_id, "stored");
 
+    ot_rom_ctrl_cache_store(s);
+
     /* compare digests and send notification */
     ot_rom_ctrl_compare_and_notify(s);
 }
@@ -531,6 +665,20 @@ static void ot_rom_ctrl_unscramble(OtRomCtrlState *s, const uint64_t *src,
 {
     unsigned scr_word_size = (size - ROM_DIGEST_BYTES) / sizeof(uint32_t);
     unsigned log_addr = 0;
+
+    /*
+     * the digest is computed over the scrambled words w/ ECC, in logical
+     * address order. Gather them while the physical address of each word is
+     * known, so that the KMAC feeder only needs to copy contiguous bytes
+     * rather than re-computing the address scrambling for each chunk.
+     */
+    g_assert(!s->se_buffer);
+    s->se_last_pos = scr_word_size * OT_ROM_CTRL_WORD_BYTES;
+    s->se_pos = 0;
+    /* add some slack as each word is stored as a 64-bit value */
+    s->se_buffer = g_new(uint8_t, s->se_last_pos + sizeof(uint64_t));
+    uint8_t *se_ptr = s->se_buffer;
+
     /* unscramble the whole ROM, except the trailing ROM digest bytes */
     s->recovered_error_count = 0;
     s->unrecoverable_error_count = 0;
@@ -538,6 +686,8 @@ static void ot_rom_ctrl_unscramble(OtRomCtrlState *s, const uint64_t *src,
         unsigned phy_addr = ot_rom_ctrl_addr_sp_enc(s, log_addr);
         g_assert(phy_addr < size);
         uint64_t srcdata = src[phy_addr];
+        stq_le_p(se_ptr, srcdata);
+        se_ptr += OT_ROM_CTRL_WORD_BYTES;
         uint64_t clrdata = ot_rom_ctrl_unscramble_word(s, log_addr, srcdata);
         dst[log_addr] = (uint32_t)clrdata;
         unsigned err;
@@ -746,20 +896,18 @@ static bool ot_rom_ctrl_load_vmem(OtRomCtrlState *s, const OtRomImg *ri,
             ot_rom_ctrl_unscramble(s, (const uint64_t *)baseptr,
                                    (uint32_t *)dst,
                                    s->size /* destination size */);
+            qemu_vfree((void *)baseptr);
         }
 
         memory_region_set_dirty(&s->mem, 0, memptr - baseptr);
 
         if (scrambled_n_ecc) {
             /* spawn hash calculation */
-            s->se_buffer = (uint64_t *)baseptr;
-            unsigned word_count =
-                (s->size - ROM_DIGEST_BYTES) / sizeof(uint32_t);
-            s->se_last_pos = word_count * OT_ROM_CTRL_WORD_BYTES;
-            s->se_pos = 0;
             ot_rom_ctrl_send_kmac_req(s);
             return true;
         }
+    } else if (scrambled_n_ecc) {
+        qemu_vfree((void *)baseptr);
     }
 
     return false;
@@ -818,6 +966,7 @@ static bool ot_rom_ctrl_load_hex(OtRomCtrlState *s, const OtRomImg *ri)
     g_assert((dst & 0x3u) == 0);
     ot_rom_ctrl_unscramble(s, (const uint64_t *)baseptr, (uint32_t *)dst,
                            s->size /* destination size */);
+    qemu_vfree((void *)baseptr);
 
     if (memptr > baseptr) {
         memory_region_set_dirty(&s->mem, 0, memptr - baseptr);
@@ -831,18 +980,17 @@ static bool ot_rom_ctrl_load_hex(OtRomCtrlState *s, const OtRomImg *ri)
         }
 
         /* spawn hash calculation */
-        s->se_buffer = (uint64_t *)baseptr;
-        unsigned word_count = (s->size - ROM_DIGEST_BYTES) / sizeof(uint32_t);
-        s->se_last_pos = word_count * OT_ROM_CTRL_WORD_BYTES;
-        s->se_pos = 0;
         ot_rom_ctrl_send_kmac_req(s);
         return true;
     }
 
+    g_free(s->se_buffer);
+    s->se_buffer = NULL;
+
     return false;
 }
 
-static bool ot_rom_ctrl_load_rom(OtRomCtrlState *s)
+static bool ot_rom_ctrl_load_rom(OtRomCtrlState *s, bool *cached)
 {
     Object *obj = NULL;
     OtRomImg *rom_img = NULL;
@@ -863,6 +1011,22 @@ static bool ot_rom_ctrl_load_rom(OtRomCtrlState *s)
     const char *basename = strrchr(rom_img->filename, '/');
     basename = basename ? basename + 1 : rom_img->filename;
 
+    /*
+     * scrambled images are costly to decode and to digest, use the decoded
+     * image from the cache directory whenever possible.
+     */
+    if (s->cache_dir && s->key_xstr && s->nonce_xstr &&
+        (rom_img->format == OT_ROM_IMG_FORMAT_VMEM_SCRAMBLED_ECC ||
+         rom_img->format == OT_ROM_IMG_FORMAT_HEX_SCRAMBLED_ECC)) {
+        s->cache_path = ot_rom_ctrl_cache_get_path(s, rom_img);
+        if (s->cache_path && ot_rom_ctrl_cache_load(s)) {
+            g_free(s->cache_path);
+            s->cache_path = NULL;
+            *cached = true;
+            return false;
+        }
+    }
+
     bool dig;
     switch (rom_img->format) {
     case OT_ROM_IMG_FORMAT_VMEM_PLAIN:
@@ -894,6 +1058,12 @@ static bool ot_rom_ctrl_load_rom(OtRomCtrlState *s)
         dig = false;
     }
 
+    if (!dig) {
+        /* nothing to cache */
+        g_free(s->cache_path);
+        s->cache_path = NULL;
+    }
+
     return dig;
 }
 
@@ -938,7 +1108,7 @@ static uint64_t ot_rom_ctrl_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_ROM_CTRL_IO_READ_OUT);
     trace_ot_rom_ctrl_io_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg),
                                   val32, pc);
 
@@ -954,7 +1124,7 @@ static void ot_rom_ctrl_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_ROM_CTRL_IO_WRITE);
     trace_ot_rom_ctrl_io_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                                pc);
 
@@ -1016,7 +1186,7 @@ static bool ot_rom_ctrl_mem_accepts(void *opaque, hwaddr addr, unsigned size,
 {
     OtRomCtrlState *s = opaque;
     (void)attrs;
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_ROM_CTRL_MEM_REJECTS);
 
     if (!is_write) {
         /*
@@ -1076,6 +1246,7 @@ static Property ot_rom_ctrl_properties[] = {
     DEFINE_PROP_UINT8("kmac-app", OtRomCtrlState, kmac_app, UINT8_MAX),
     DEFINE_PROP_STRING("nonce", OtRomCtrlState, nonce_xstr),
     DEFINE_PROP_STRING("key", OtRomCtrlState, key_xstr),
+    DEFINE_PROP_STRING("cache-dir", OtRomCtrlState, cache_dir),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -1140,12 +1311,13 @@ static void ot_rom_ctrl_reset_exit(Object *obj, ResetType type)
         memset(rom_ptr, 0, s->size);
 
         /* load ROM from file */
-        bool dig = ot_rom_ctrl_load_rom(s);
+        bool cached = false;
+        bool dig = ot_rom_ctrl_load_rom(s, &cached);
 
         /* ensure ROM can no longer be written */
         s->first_reset = false;
 
-        if (!dig) {
+        if (!dig && !cached) {
             ot_rom_ctrl_fake_digest(s);
         }
 
@@ -1184,7 +1356,6 @@ static void ot_rom_ctrl_realize(DeviceState *dev, Error **errp)
      */
     s->first_reset = true;
     s->se_buffer = NULL;
-    fifo8_reset(&s->hash_fifo);
     memory_region_rom_device_set_romd(&s->mem, false);
 
     unsigned wsize = s->size / sizeof(uint32_t);
@@ -1224,8 +1395,6 @@ static void ot_rom_ctrl_init(Object *obj)
     sysbus_init_mmio(SYS_BUS_DEVICE(s), &s->mmio);
 
     ibex_qdev_init_irq(obj, &s->alert, OT_DEVICE_ALERT);
-
-    fifo8_create(&s->hash_fifo, OT_KMAC_APP_MSG_BYTES);
 }
 
 static void ot_rom_ctrl_class_init(ObjectClass *klass, void *data)
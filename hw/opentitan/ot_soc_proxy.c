@@ -176,7 +176,7 @@ static uint64_t ot_soc_proxy_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SOC_PROXY_IO_READ_OUT);
     trace_ot_soc_proxy_io_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg),
                                    val32, pc);
 
@@ -192,7 +192,7 @@ static void ot_soc_proxy_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SOC_PROXY_IO_WRITE);
     trace_ot_soc_proxy_io_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                                 pc);
 
@@ -574,7 +574,7 @@ ot_socdbg_ctrl_core_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SOCDBG_CTRL_CORE_IO_READ_OUT);
     trace_ot_socdbg_ctrl_core_io_read_out(s->ot_id, (uint32_t)addr,
                                           REG_NAME(CORE, reg), val32, pc);
 
@@ -590,7 +590,7 @@ static void ot_socdbg_ctrl_core_write(void *opaque, hwaddr addr, uint64_t value,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SOCDBG_CTRL_CORE_IO_WRITE);
     trace_ot_socdbg_ctrl_core_io_write(s->ot_id, (uint32_t)addr,
                                        REG_NAME(CORE, reg), val32, pc);
 
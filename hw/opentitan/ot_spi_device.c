@@ -1783,7 +1783,8 @@ ot_spi_device_spi_regs_read(void *opaque, hwaddr addr, unsigned size)
     }
 
     if (reg != R_INTR_STATE || val32 != 0) {
-        uint32_t pc = ibex_get_current_pc();
+        uint32_t pc =
+            ibex_get_current_pc_if(TRACE_OT_SPI_DEVICE_IO_SPI_READ_OUT);
         trace_ot_spi_device_io_spi_read_out((uint32_t)addr, SPI_REG_NAME(reg),
                                             val32, pc);
     }
@@ -1800,7 +1801,7 @@ static void ot_spi_device_spi_regs_write(void *opaque, hwaddr addr,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SPI_DEVICE_IO_SPI_WRITE_IN);
     trace_ot_spi_device_io_spi_write_in((uint32_t)addr, SPI_REG_NAME(reg),
                                         val32, pc);
 
@@ -2023,7 +2024,7 @@ ot_spi_device_tpm_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SPI_DEVICE_IO_TPM_READ_OUT);
     trace_ot_spi_device_io_tpm_read_out((uint32_t)addr, TPM_REG_NAME(reg),
                                         val32, pc);
 
@@ -2039,7 +2040,7 @@ static void ot_spi_device_tpm_regs_write(void *opaque, hwaddr addr,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SPI_DEVICE_IO_TPM_WRITE_IN);
     trace_ot_spi_device_io_tpm_write_in((uint32_t)addr, TPM_REG_NAME(reg),
                                         val32, pc);
 
@@ -2135,7 +2136,7 @@ static MemTxResult ot_spi_device_buf_read_with_attrs(
     g_assert((addr_offset + size) <= 4u);
     val32 >>= addr_offset << 3u;
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SPI_DEVICE_BUF_READ_OUT);
     trace_ot_spi_device_buf_read_out((uint32_t)addr, size, val32, pc);
 
     *val64 = (uint64_t)val32;
@@ -2150,7 +2151,7 @@ static MemTxResult ot_spi_device_buf_write_with_attrs(
     (void)attrs;
 
     uint32_t val32 = (uint32_t)val64;
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SPI_DEVICE_BUF_WRITE_IN);
     trace_ot_spi_device_buf_write_in((uint32_t)addr, size, val32, pc);
 
     hwaddr last = addr + size - 1u;
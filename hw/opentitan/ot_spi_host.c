@@ -990,7 +990,7 @@ static uint64_t ot_spi_host_io_read(void *opaque, hwaddr addr,
                       s->ot_id, addr);
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SPI_HOST_IO_READ);
 
 #ifdef DISCARD_REPEATED_STATUS_TRACES
     static TraceCache trace_cache;
@@ -1027,7 +1027,7 @@ static void ot_spi_host_io_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SPI_HOST_IO_WRITE);
     trace_ot_spi_host_io_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                                pc);
 
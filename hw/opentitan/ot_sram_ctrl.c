@@ -29,14 +29,19 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/bitmap.h"
+#include "qemu/bswap.h"
 #include "qemu/error-report.h"
+#include "qemu/guest-random.h"
 #include "qemu/log.h"
 #include "qemu/main-loop.h"
 #include "qemu/timer.h"
 #include "qemu/typedefs.h"
+#include "qapi/error.h"
 #include "hw/opentitan/ot_alert.h"
 #include "hw/opentitan/ot_common.h"
 #include "hw/opentitan/ot_otp.h"
+#include "hw/opentitan/ot_prince.h"
 #include "hw/opentitan/ot_prng.h"
 #include "hw/opentitan/ot_sram_ctrl.h"
 #include "hw/qdev-properties.h"
@@ -44,6 +49,7 @@
 #include "hw/riscv/ibex_common.h"
 #include "hw/riscv/ibex_irq.h"
 #include "hw/sysbus.h"
+#include "migration/vmstate.h"
 #include "trace.h"
 
 #undef OT_SRAM_CTRL_DEBUG
@@ -85,6 +91,13 @@ REG32(SCR_KEY_ROTATED, 0x1cu)
 #define INIT_TIMER_CHUNK_NS    100000 /* 100 us */
 #define INIT_TIMER_CHUNK_WORDS (4096u / sizeof(uint32_t)) /* 4 KB */
 
+/* granule of SRAM pages that may be individually switched to host RAM */
+#define SRAM_PAGE_SIZE  4096u
+#define SRAM_PAGE_WORDS (SRAM_PAGE_SIZE / sizeof(uint32_t))
+#define SRAM_PAGE_SLOTS (SRAM_PAGE_WORDS / 64u) /* init_sram_bm slots */
+
+#define SCR_NUM_PRINCE_HALF_ROUNDS 3u
+
 /* clang-format off */
 #define REG_NAME_ENTRY(_reg_) [R_##_reg_] = stringify(_reg_)
 static const char *REG_NAMES[REGS_COUNT] = {
@@ -103,6 +116,7 @@ typedef struct {
     MemoryRegion alias; /* SRAM alias on one of the following */
     MemoryRegion sram; /* SRAM memory (runtime) */
     MemoryRegion init; /* SRAM memory (not yet initialized) */
+    MemoryRegion *pages; /* per-page SRAM aliases, overlaid on init */
 } OtSramCtrlMem;
 
 struct OtSramCtrlState {
@@ -112,20 +126,32 @@ struct OtSramCtrlState {
     OtSramCtrlMem *mem; /* SRAM memory */
     IbexIRQ alert;
     QEMUBH *switch_mr_bh; /* switch memory region */
+    QEMUBH *switch_page_bh; /* switch initialized pages to host RAM */
     QEMUTimer *init_timer; /* SRAM initialization timer */
+    OtPollWatch poll; /* STATUS poll loop tracker */
 
     uint64_t *init_sram_bm; /* initialization bitmap */
     uint64_t *init_slot_bm; /* initialization bitmap shortcut */
+    unsigned long *page_ram_bm; /* pages currently mapped as host RAM */
+    unsigned long *page_pending_bm; /* pages waiting to be mapped as RAM */
+    unsigned long *page_clear_bm; /* pages w/ a valid plaintext shadow */
+    uint32_t *scr_mem; /* scrambled SRAM storage */
+    uint64_t scr_keys[2u]; /* PRINCE key (hi, lo) */
+    uint64_t scr_nonce; /* PRINCE nonce */
+    unsigned scr_addr_width; /* width of 64-bit block address */
     OtPrngState *prng; /* simplified PRNG, does not match OT's */
     OtOTPKey *otp_key;
     uint32_t regs[REGS_COUNT];
     unsigned init_slot_count; /* count of init_slot_bm */
+    unsigned cell_slot_count; /* count of init_sram_bm */
     unsigned init_slot_pos; /* current SRAM cell (word-sized) for init. */
     unsigned wsize; /* size of RAM in words */
+    unsigned page_count; /* count of SRAM pages */
     bool initialized; /* SRAM has been fully initialized at least once */
     bool initializing; /* CTRL.INIT has been requested */
     bool otp_ifetch;
     bool cfg_ifetch;
+    bool ram_mapped; /* whole SRAM mapped as host RAM (migration) */
 
     char *ot_id;
     OtOTPState *otp_ctrl; /* optional */
@@ -134,6 +160,8 @@ struct OtSramCtrlState {
     bool ifetch; /* only used when no otp_ctrl is defined */
     bool noinit; /* discard initialization emulation feature */
     bool noswitch; /* do not switch to performance/host RAM after init */
+    bool scramble; /* emulate data scrambling */
+    bool fast_poll; /* complete init early on STATUS poll loop */
 };
 
 #ifdef OT_SRAM_CTRL_DEBUG
@@ -189,6 +217,149 @@ static bool ot_sram_ctrl_mem_is_fully_initialized(const OtSramCtrlState *s)
     return true;
 }
 
+static bool
+ot_sram_ctrl_mem_is_page_initialized(const OtSramCtrlState *s, unsigned page)
+{
+    size_t cell_slot_count = ot_sram_ctrl_get_slot_count(s->wsize);
+    size_t start = (size_t)page * SRAM_PAGE_SLOTS;
+    size_t end = MIN(start + SRAM_PAGE_SLOTS, cell_slot_count);
+
+    for (size_t ix = start; ix < end; ix++) {
+        if (s->init_sram_bm[ix]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void ot_sram_ctrl_mem_map_page(OtSramCtrlState *s, unsigned page)
+{
+    if (s->noswitch || test_bit(page, s->page_ram_bm) ||
+        test_bit(page, s->page_pending_bm)) {
+        return;
+    }
+
+    if (s->scramble && !test_bit(page, s->page_clear_bm)) {
+        return;
+    }
+
+    if (!ot_sram_ctrl_mem_is_page_initialized(s, page)) {
+        return;
+    }
+
+    /*
+     * do not switch the page in the middle of the current access, defer it to
+     * a BH as for the whole memory region switch
+     */
+    set_bit(page, s->page_pending_bm);
+    qemu_bh_schedule(s->switch_page_bh);
+}
+
+static void
+ot_sram_ctrl_scr_crypt_page(const OtSramCtrlState *s, unsigned page,
+                            const uint32_t *src, uint32_t *dst)
+{
+    unsigned start = page * SRAM_PAGE_WORDS;
+    unsigned end = MIN(start + SRAM_PAGE_WORDS, s->wsize);
+
+    /*
+     * PRINCE is run in counter mode, one 64-bit keystream block for each pair
+     * of 32-bit words. As the keystream is XORed with the data, the same
+     * function is used to scramble and to descramble.
+     * Address scrambling is not emulated: each word is stored at its logical
+     * location in the scrambled storage.
+     */
+    for (unsigned ix = start; ix < end; ix += 2u) {
+        uint64_t block = (s->scr_nonce << s->scr_addr_width) | (ix >> 1u);
+        uint64_t stream = ot_prince_run(block, s->scr_keys[0u],
+                                        s->scr_keys[1u],
+                                        SCR_NUM_PRINCE_HALF_ROUNDS);
+        dst[ix] = src[ix] ^ (uint32_t)stream;
+        if (ix + 1u < end) {
+            dst[ix + 1u] = src[ix + 1u] ^ (uint32_t)(stream >> 32u);
+        }
+    }
+}
+
+static void ot_sram_ctrl_scr_load_page(OtSramCtrlState *s, unsigned page)
+{
+    if (!s->scramble || test_bit(page, s->page_clear_bm)) {
+        return;
+    }
+
+    /* descramble the page into its plaintext shadow with the current key */
+    uint32_t *mem = memory_region_get_ram_ptr(&s->mem->sram);
+    ot_sram_ctrl_scr_crypt_page(s, page, s->scr_mem, mem);
+    memory_region_set_dirty(&s->mem->sram, page * SRAM_PAGE_SIZE,
+                            memory_region_size(&s->mem->pages[page]));
+    set_bit(page, s->page_clear_bm);
+
+    trace_ot_sram_ctrl_scr_load_page(s->ot_id, page);
+
+    if (s->initialized && !s->noswitch &&
+        bitmap_full(s->page_clear_bm, s->page_count)) {
+        /* all pages are available in plaintext, switch the whole memory */
+        qemu_bh_schedule(s->switch_mr_bh);
+    }
+}
+
+static void ot_sram_ctrl_scr_prepare(OtSramCtrlState *s, unsigned start,
+                                     unsigned end)
+{
+    /* the [start..end[ word range is about to be overwritten */
+    for (unsigned page = start / SRAM_PAGE_WORDS;
+         page < DIV_ROUND_UP(end, SRAM_PAGE_WORDS); page++) {
+        unsigned pstart = page * SRAM_PAGE_WORDS;
+        unsigned pend = MIN(pstart + SRAM_PAGE_WORDS, s->wsize);
+        if (start <= pstart && end >= pend) {
+            /* no need to descramble a page which is fully overwritten */
+            set_bit(page, s->page_clear_bm);
+        } else {
+            ot_sram_ctrl_scr_load_page(s, page);
+        }
+    }
+}
+
+static void ot_sram_ctrl_scr_flush(OtSramCtrlState *s)
+{
+    const uint32_t *mem = memory_region_get_ram_ptr(&s->mem->sram);
+    unsigned count = 0;
+
+    /* scramble back all plaintext shadow pages with the current key */
+    unsigned long page;
+    for (page = find_first_bit(s->page_clear_bm, s->page_count);
+         page < s->page_count;
+         page = find_next_bit(s->page_clear_bm, s->page_count, page + 1u)) {
+        ot_sram_ctrl_scr_crypt_page(s, page, mem, s->scr_mem);
+        count += 1u;
+    }
+    bitmap_zero(s->page_clear_bm, s->page_count);
+
+    trace_ot_sram_ctrl_scr_flush(s->ot_id, count);
+}
+
+static void ot_sram_ctrl_mem_unmap_pages(OtSramCtrlState *s)
+{
+    bitmap_zero(s->page_pending_bm, s->page_count);
+
+    if (bitmap_empty(s->page_ram_bm, s->page_count)) {
+        return;
+    }
+
+    memory_region_transaction_begin();
+    unsigned long page;
+    for (page = find_first_bit(s->page_ram_bm, s->page_count);
+         page < s->page_count;
+         page = find_next_bit(s->page_ram_bm, s->page_count, page + 1u)) {
+        memory_region_del_subregion(&s->mem->init, &s->mem->pages[page]);
+    }
+    memory_region_transaction_commit();
+    bitmap_zero(s->page_ram_bm, s->page_count);
+
+    trace_ot_sram_ctrl_switch_mem(s->ot_id, "io pages");
+}
+
 static bool ot_sram_ctrl_initialize(OtSramCtrlState *s, unsigned count,
                                     bool expedite)
 {
@@ -199,6 +370,10 @@ static bool ot_sram_ctrl_initialize(OtSramCtrlState *s, unsigned count,
     trace_ot_sram_ctrl_initialize(s->ot_id, s->init_slot_pos * sizeof(uint32_t),
                                   end * sizeof(uint32_t), count, expedite);
 
+    if (s->scramble) {
+        ot_sram_ctrl_scr_prepare(s, s->init_slot_pos, end);
+    }
+
     uint32_t *mem = memory_region_get_ram_ptr(&s->mem->sram);
     mem += s->init_slot_pos;
 
@@ -246,6 +421,44 @@ static bool ot_sram_ctrl_initialize(OtSramCtrlState *s, unsigned count,
     return false;
 }
 
+static void ot_sram_ctrl_mem_switch_to_io(OtSramCtrlState *s)
+{
+    qemu_bh_cancel(s->switch_mr_bh);
+
+    if (s->mem->alias.alias != &s->mem->init) {
+        memory_region_transaction_begin();
+        memory_region_set_enabled(&s->mem->init, true);
+        memory_region_set_enabled(&s->mem->sram, false);
+        s->mem->alias.alias = &s->mem->init;
+        memory_region_transaction_commit();
+    }
+
+    ot_sram_ctrl_mem_unmap_pages(s);
+}
+
+static void ot_sram_ctrl_scr_rekey(OtSramCtrlState *s, const uint8_t *key,
+                                   unsigned key_size, const uint8_t *nonce,
+                                   unsigned nonce_size)
+{
+    /* store the current plaintext content with the former key */
+    ot_sram_ctrl_scr_flush(s);
+
+    uint8_t buf[sizeof(s->scr_keys)] = { 0 };
+    memcpy(buf, key, MIN(key_size, sizeof(buf)));
+    s->scr_keys[0u] = ldq_be_p(&buf[0u]);
+    s->scr_keys[1u] = ldq_be_p(&buf[8u]);
+    memset(buf, 0, sizeof(buf));
+    memcpy(buf, nonce, MIN(nonce_size, sizeof(s->scr_nonce)));
+    s->scr_nonce = ldq_be_p(buf);
+
+    /*
+     * all plaintext shadow pages are now stale: route all accesses through
+     * the I/O backend so that pages get descrambled with the new key on
+     * demand.
+     */
+    ot_sram_ctrl_mem_switch_to_io(s);
+}
+
 static void ot_sram_ctrl_reseed(OtSramCtrlState *s)
 {
     s->regs[R_STATUS] &=
@@ -264,12 +477,17 @@ static void ot_sram_ctrl_reseed(OtSramCtrlState *s)
 
     /*
      * Note: in order to keep the implementation simple, the full OT HW behavior
-     *       is not reproced here (with CPU cycle delays to obtain the key, etc.
-     *       Tke key retrieval is therefore synchronous, which does not
+     *       is not reproduced here (with CPU cycle delays to obtain the key,
+     *       etc.). The key retrieval is therefore synchronous, which does not
      *       precisely emulate the HW.
-     *       Moreover the scrambling is highly simplified, as for now there is
-     *       neither PRINCE block cipher nor shallow substitution-permutation.
-     *       Seed and Nonce are combined to initialize a QEMU PRNG instance.
+     *       In both modes, seed and nonce are combined to reseed the PRNG
+     *       instance used to fill the memory on initialization requests.
+     *       By default, the memory content is stored in plain text and is
+     *       kept across key renewals. With the scramble property, the content
+     *       is stored encrypted with PRINCE in counter mode, keyed from the
+     *       seed and the nonce, so that it reads back as garbage once the key
+     *       is renewed. Neither the address scrambling nor the shallow
+     *       substitution-permutation network of the HW is emulated.
      */
     OtOTPStateClass *oc =
         OBJECT_GET_CLASS(OtOTPStateClass, s->otp_ctrl, TYPE_OT_OTP);
@@ -305,6 +523,19 @@ static void ot_sram_ctrl_reseed(OtSramCtrlState *s)
         ot_prng_reseed_array(s->prng, buffer,
                              (s->otp_key->seed_size + s->otp_key->nonce_size) /
                                  sizeof(uint32_t));
+
+        if (s->scramble) {
+            ot_sram_ctrl_scr_rekey(s, s->otp_key->seed, s->otp_key->seed_size,
+                                   s->otp_key->nonce, s->otp_key->nonce_size);
+        }
+    } else if (s->scramble) {
+        /* no OTP key, use a random key so that former content is lost */
+        uint32_t buffer[(sizeof(s->scr_keys) + sizeof(s->scr_nonce)) /
+                        sizeof(uint32_t)];
+        ot_prng_random_u32_array(s->prng, buffer, ARRAY_SIZE(buffer));
+        const uint8_t *buf = (const uint8_t *)&buffer[0];
+        ot_sram_ctrl_scr_rekey(s, buf, sizeof(s->scr_keys),
+                               &buf[sizeof(s->scr_keys)], sizeof(s->scr_nonce));
     }
 
     s->regs[R_CTRL] &= ~R_CTRL_RENEW_SCR_KEY_MASK;
@@ -321,13 +552,8 @@ static void ot_sram_ctrl_start_initialization(OtSramCtrlState *s)
 
     trace_ot_sram_ctrl_request_hw_init(s->ot_id);
 
-    if (s->mem->alias.alias != &s->mem->init) {
-        memory_region_transaction_begin();
-        memory_region_set_enabled(&s->mem->init, true);
-        memory_region_set_enabled(&s->mem->sram, false);
-        s->mem->alias.alias = &s->mem->init;
-        memory_region_transaction_commit();
-    }
+    /* pages are being re-initialized, route all accesses through I/O */
+    ot_sram_ctrl_mem_switch_to_io(s);
 
     s->init_slot_pos = 0;
 
@@ -346,6 +572,11 @@ static uint64_t ot_sram_ctrl_regs_read(void *opaque, hwaddr addr, unsigned size)
 
     switch (reg) {
     case R_STATUS:
+        if (s->fast_poll) {
+            ot_common_poll_watch(&s->poll, s->ot_id, addr);
+        }
+        val32 = s->regs[reg];
+        break;
     case R_EXEC_REGWEN:
     case R_EXEC:
     case R_CTRL_REGWEN:
@@ -366,7 +597,7 @@ static uint64_t ot_sram_ctrl_regs_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SRAM_CTRL_IO_READ_OUT);
     trace_ot_sram_ctrl_io_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg),
                                    val32, pc);
 
@@ -382,7 +613,7 @@ static void ot_sram_ctrl_regs_write(void *opaque, hwaddr addr, uint64_t val64,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SRAM_CTRL_IO_WRITE);
     trace_ot_sram_ctrl_io_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                                 pc);
 
@@ -457,6 +688,12 @@ static void ot_sram_ctrl_mem_switch_to_ram_fn(void *opaque)
 {
     OtSramCtrlState *s = opaque;
 
+    if (s->scramble && !bitmap_full(s->page_clear_bm, s->page_count)) {
+        /* some pages still need to be descrambled w/ the current key */
+        trace_ot_sram_ctrl_no_mem_change(s->ot_id, "scrambled pages");
+        return;
+    }
+
     memory_region_transaction_begin();
     memory_region_set_enabled(&s->mem->init, false);
     memory_region_set_enabled(&s->mem->sram, true);
@@ -465,6 +702,44 @@ static void ot_sram_ctrl_mem_switch_to_ram_fn(void *opaque)
     memory_region_set_dirty(&s->mem->sram, 0, s->size);
 
     trace_ot_sram_ctrl_switch_mem(s->ot_id, "ram");
+
+    /* page aliases are useless once the whole SRAM is mapped as RAM */
+    ot_sram_ctrl_mem_unmap_pages(s);
+}
+
+static void ot_sram_ctrl_mem_switch_pages_to_ram_fn(void *opaque)
+{
+    OtSramCtrlState *s = opaque;
+
+    if (s->initializing || s->mem->alias.alias != &s->mem->init) {
+        /* either being re-initialized or already fully switched to RAM */
+        bitmap_zero(s->page_pending_bm, s->page_count);
+        return;
+    }
+
+    unsigned count = 0;
+    memory_region_transaction_begin();
+    unsigned long page;
+    for (page = find_first_bit(s->page_pending_bm, s->page_count);
+         page < s->page_count;
+         page = find_next_bit(s->page_pending_bm, s->page_count, page + 1u)) {
+        /*
+         * an initialized page is overlaid on top of the I/O region with a
+         * direct alias to the host RAM, so that it can be accessed w/o the
+         * initialization check overhead
+         */
+        memory_region_add_subregion_overlap(&s->mem->init,
+                                            page * SRAM_PAGE_SIZE,
+                                            &s->mem->pages[page], 1);
+        memory_region_set_dirty(&s->mem->sram, page * SRAM_PAGE_SIZE,
+                                memory_region_size(&s->mem->pages[page]));
+        set_bit(page, s->page_ram_bm);
+        count += 1u;
+    }
+    memory_region_transaction_commit();
+    bitmap_zero(s->page_pending_bm, s->page_count);
+
+    trace_ot_sram_ctrl_switch_pages(s->ot_id, count);
 }
 
 static void ot_sram_ctrl_init_chunk_fn(void *opaque)
@@ -484,7 +759,7 @@ static MemTxResult ot_sram_ctrl_mem_init_read_with_attrs(
     (void)size;
     (void)attrs;
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SRAM_CTRL_MEM_IO_READO);
 
     unsigned cell = addr >> 2u;
     unsigned addr_offset = (addr & 3u);
@@ -506,6 +781,9 @@ static MemTxResult ot_sram_ctrl_mem_init_read_with_attrs(
         g_assert(done);
     }
 
+    unsigned page = cell / SRAM_PAGE_WORDS;
+    ot_sram_ctrl_scr_load_page(s, page);
+
     if (!s->initialized) {
         /*
          * the whole RAM is not fully initialized, check if this cell has been
@@ -533,6 +811,11 @@ static MemTxResult ot_sram_ctrl_mem_init_read_with_attrs(
 
     trace_ot_sram_ctrl_mem_io_reado(s->ot_id, (uint32_t)addr, size, val32, pc);
 
+    if (s->scramble) {
+        /* initialized page may have been descrambled */
+        ot_sram_ctrl_mem_map_page(s, page);
+    }
+
     return MEMTX_OK;
 }
 
@@ -542,7 +825,7 @@ static MemTxResult ot_sram_ctrl_mem_init_write_with_attrs(
     OtSramCtrlState *s = opaque;
     (void)attrs;
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_SRAM_CTRL_MEM_IO_WRITE);
     trace_ot_sram_ctrl_mem_io_write(s->ot_id, (uint32_t)addr, size,
                                     (uint32_t)val64, pc);
 
@@ -568,6 +851,9 @@ static MemTxResult ot_sram_ctrl_mem_init_write_with_attrs(
         g_assert(done);
     }
 
+    unsigned page = cell / SRAM_PAGE_WORDS;
+    ot_sram_ctrl_scr_load_page(s, page);
+
     /* store the value into the final SRAM region */
     uint32_t *mem = memory_region_get_ram_ptr(&s->mem->sram);
 
@@ -584,6 +870,11 @@ static MemTxResult ot_sram_ctrl_mem_init_write_with_attrs(
         return MEMTX_OK;
     }
 
+    if (s->scramble && s->initialized) {
+        /* descrambled page of a fully initialized memory */
+        ot_sram_ctrl_mem_map_page(s, page);
+    }
+
     unsigned idx = addr / sizeof(uint32_t);
     unsigned slot = ot_sram_ctrl_get_u64_slot(idx);
     unsigned offset = ot_sram_ctrl_get_u64_offset(idx);
@@ -591,6 +882,8 @@ static MemTxResult ot_sram_ctrl_mem_init_write_with_attrs(
     s->init_sram_bm[slot] &= ~(1ull << offset);
 
     if (!s->init_sram_bm[slot]) {
+        ot_sram_ctrl_mem_map_page(s, page);
+
         offset = ot_sram_ctrl_get_u64_offset(slot);
         slot = ot_sram_ctrl_get_u64_slot(slot);
         s->init_slot_bm[slot] &= ~(1ull << offset);
@@ -629,6 +922,8 @@ static Property ot_sram_ctrl_properties[] = {
     DEFINE_PROP_BOOL("ifetch", OtSramCtrlState, ifetch, false),
     DEFINE_PROP_BOOL("noinit", OtSramCtrlState, noinit, false),
     DEFINE_PROP_BOOL("noswitch", OtSramCtrlState, noswitch, false),
+    DEFINE_PROP_BOOL("scramble", OtSramCtrlState, scramble, false),
+    DEFINE_PROP_BOOL("fast-poll", OtSramCtrlState, fast_poll, false),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -648,6 +943,109 @@ static const MemoryRegionOps ot_sram_ctrl_mem_init_ops = {
     .impl.max_access_size = 4u,
 };
 
+static int ot_sram_ctrl_pre_save(void *opaque)
+{
+    OtSramCtrlState *s = opaque;
+
+    if (s->noinit) {
+        return 0;
+    }
+
+    s->ram_mapped = s->mem->alias.alias == &s->mem->sram;
+
+    if (s->scramble) {
+        /*
+         * make the scrambled storage reflect the current content, while
+         * keeping the plaintext shadow valid
+         */
+        const uint32_t *mem = memory_region_get_ram_ptr(&s->mem->sram);
+        unsigned long page;
+        for (page = find_first_bit(s->page_clear_bm, s->page_count);
+             page < s->page_count;
+             page = find_next_bit(s->page_clear_bm, s->page_count, page + 1u)) {
+            ot_sram_ctrl_scr_crypt_page(s, page, mem, s->scr_mem);
+        }
+    }
+
+    return 0;
+}
+
+static int ot_sram_ctrl_post_load(void *opaque, int version_id)
+{
+    OtSramCtrlState *s = opaque;
+    (void)version_id;
+
+    if (s->noinit) {
+        return 0;
+    }
+
+    ot_sram_ctrl_mem_switch_to_io(s);
+
+    if (s->scramble) {
+        /* plaintext shadow is rebuilt on demand from the scrambled storage */
+        bitmap_zero(s->page_clear_bm, s->page_count);
+    }
+
+    if (s->ram_mapped && !s->scramble) {
+        ot_sram_ctrl_mem_switch_to_ram_fn(s);
+    } else if (!s->initializing) {
+        for (unsigned page = 0; page < s->page_count; page++) {
+            ot_sram_ctrl_mem_map_page(s, page);
+        }
+    }
+
+    return 0;
+}
+
+static bool ot_sram_ctrl_scramble_needed(void *opaque)
+{
+    OtSramCtrlState *s = opaque;
+
+    return s->scramble;
+}
+
+static const VMStateDescription vmstate_ot_sram_ctrl_scramble = {
+    .name = TYPE_OT_SRAM_CTRL "/scramble",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .needed = &ot_sram_ctrl_scramble_needed,
+    .fields = (const VMStateField[]) {
+        VMSTATE_VARRAY_UINT32(scr_mem, OtSramCtrlState, wsize, 0,
+                              vmstate_info_uint32, uint32_t),
+        VMSTATE_UINT64_ARRAY(scr_keys, OtSramCtrlState, 2u),
+        VMSTATE_UINT64(scr_nonce, OtSramCtrlState),
+        VMSTATE_END_OF_LIST(),
+    },
+};
+
+static const VMStateDescription vmstate_ot_sram_ctrl = {
+    .name = TYPE_OT_SRAM_CTRL,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .pre_save = &ot_sram_ctrl_pre_save,
+    .post_load = &ot_sram_ctrl_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32_ARRAY(regs, OtSramCtrlState, REGS_COUNT),
+        VMSTATE_VARRAY_UINT32(init_sram_bm, OtSramCtrlState, cell_slot_count,
+                              0, vmstate_info_uint64, uint64_t),
+        VMSTATE_VARRAY_UINT32(init_slot_bm, OtSramCtrlState, init_slot_count,
+                              0, vmstate_info_uint64, uint64_t),
+        VMSTATE_UINT32(init_slot_pos, OtSramCtrlState),
+        VMSTATE_BOOL(initialized, OtSramCtrlState),
+        VMSTATE_BOOL(initializing, OtSramCtrlState),
+        VMSTATE_BOOL(otp_ifetch, OtSramCtrlState),
+        VMSTATE_BOOL(cfg_ifetch, OtSramCtrlState),
+        VMSTATE_BOOL(ram_mapped, OtSramCtrlState),
+        VMSTATE_TIMER_PTR(init_timer, OtSramCtrlState),
+        VMSTATE_IBEX_IRQ(alert, OtSramCtrlState),
+        VMSTATE_END_OF_LIST(),
+    },
+    .subsections = (const VMStateDescription * const []) {
+        &vmstate_ot_sram_ctrl_scramble,
+        NULL,
+    },
+};
+
 static void ot_sram_ctrl_reset(DeviceState *dev)
 {
     OtSramCtrlState *s = OT_SRAM_CTRL(dev);
@@ -673,8 +1071,9 @@ static void ot_sram_ctrl_reset(DeviceState *dev)
 
     ibex_irq_set(&s->alert, (int)(bool)s->regs[R_ALERT_TEST]);
 
-    int64_t now = qemu_clock_get_ms(QEMU_CLOCK_REALTIME);
-    ot_prng_reseed(s->prng, (uint32_t)now);
+    uint32_t seed[8u];
+    qemu_guest_getrandom_nofail(seed, sizeof(seed));
+    ot_prng_reseed_array(s->prng, seed, ARRAY_SIZE(seed));
 }
 
 static void ot_sram_ctrl_realize(DeviceState *dev, Error **errp)
@@ -700,6 +1099,12 @@ static void ot_sram_ctrl_realize(DeviceState *dev, Error **errp)
 
     char *mr_name;
 
+    if (s->noinit && s->scramble) {
+        error_setg(errp, "%s: %s scrambling requires initialization support",
+                   __func__, s->ot_id);
+        return;
+    }
+
     if (s->noinit) {
         /*
          * when initialization feature is disabled, simply map the final memory
@@ -709,6 +1114,7 @@ static void ot_sram_ctrl_realize(DeviceState *dev, Error **errp)
         mr_name = g_strdup_printf(TYPE_OT_SRAM_CTRL ".%s.mem", s->ot_id);
         memory_region_init_ram_nomigrate(&s->mem->sram, OBJECT(dev), mr_name,
                                          size, errp);
+        vmstate_register_ram(&s->mem->sram, dev);
         sysbus_init_mmio(SYS_BUS_DEVICE(s), &s->mem->sram);
         g_free(mr_name);
         return;
@@ -732,6 +1138,7 @@ static void ot_sram_ctrl_realize(DeviceState *dev, Error **errp)
      * than host-backed memory.
      */
     size_t cell_slot_count = ot_sram_ctrl_get_slot_count(s->wsize);
+    s->cell_slot_count = (unsigned)cell_slot_count;
     s->init_sram_bm = g_new0(uint64_t, cell_slot_count);
     memset(s->init_sram_bm, 0xff, cell_slot_count * sizeof(uint64_t));
 
@@ -750,8 +1157,42 @@ static void ot_sram_ctrl_realize(DeviceState *dev, Error **errp)
     mr_name = g_strdup_printf(TYPE_OT_SRAM_CTRL ".%s.mem.sram", s->ot_id);
     memory_region_init_ram_nomigrate(&s->mem->sram, OBJECT(dev), mr_name, size,
                                      errp);
+    vmstate_register_ram(&s->mem->sram, dev);
     g_free(mr_name);
 
+    /*
+     * once all the cells of a page have been initialized, the page is mapped
+     * as host RAM through a dedicated alias laid over the I/O backend, so that
+     * firmware which only initializes part of the SRAM does not suffer from
+     * the I/O backend bottleneck for the initialized pages.
+     */
+    s->page_count = DIV_ROUND_UP(size, SRAM_PAGE_SIZE);
+    s->page_ram_bm = bitmap_new(s->page_count);
+    s->page_pending_bm = bitmap_new(s->page_count);
+    s->page_clear_bm = bitmap_new(s->page_count);
+    s->mem->pages = g_new0(MemoryRegion, s->page_count);
+    for (unsigned page = 0; page < s->page_count; page++) {
+        hwaddr offset = page * SRAM_PAGE_SIZE;
+        mr_name =
+            g_strdup_printf(TYPE_OT_SRAM_CTRL ".%s.mem.page%u", s->ot_id, page);
+        memory_region_init_alias(&s->mem->pages[page], OBJECT(dev), mr_name,
+                                 &s->mem->sram, offset,
+                                 MIN(SRAM_PAGE_SIZE, size - offset));
+        g_free(mr_name);
+    }
+
+    if (s->scramble) {
+        /*
+         * scrambled content is only stored on key renewal: the host RAM
+         * backend acts as a plaintext shadow of the scrambled storage, which
+         * is lazily descrambled, one page at a time, with the current key.
+         * Until the first key renewal, the plaintext shadow is valid.
+         */
+        s->scr_mem = g_new0(uint32_t, s->wsize);
+        s->scr_addr_width = 64u - clz64(DIV_ROUND_UP(s->wsize, 2u));
+        bitmap_fill(s->page_clear_bm, s->page_count);
+    }
+
     /*
      * use an alias than points to the currently selected RAM backend, either
      * I/O for controlling access but really slow or host RAM backend for speed
@@ -786,8 +1227,11 @@ static void ot_sram_ctrl_init(Object *obj)
 
     s->mem = g_new0(OtSramCtrlMem, 1u);
     s->switch_mr_bh = qemu_bh_new(&ot_sram_ctrl_mem_switch_to_ram_fn, s);
+    s->switch_page_bh =
+        qemu_bh_new(&ot_sram_ctrl_mem_switch_pages_to_ram_fn, s);
     s->init_timer =
         timer_new_ns(OT_VIRTUAL_CLOCK, &ot_sram_ctrl_init_chunk_fn, s);
+    ot_common_poll_watch_init(&s->poll, s->init_timer);
     s->prng = ot_prng_allocate();
     s->otp_key = g_new0(OtOTPKey, 1u);
 }
@@ -799,6 +1243,7 @@ static void ot_sram_ctrl_class_init(ObjectClass *klass, void *data)
 
     dc->reset = &ot_sram_ctrl_reset;
     dc->realize = &ot_sram_ctrl_realize;
+    dc->vmsd = &vmstate_ot_sram_ctrl;
     device_class_set_props(dc, ot_sram_ctrl_properties);
     set_bit(DEVICE_CATEGORY_MISC, dc->categories);
 }
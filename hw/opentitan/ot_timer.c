@@ -35,6 +35,7 @@
 #include "hw/registerfields.h"
 #include "hw/riscv/ibex_common.h"
 #include "hw/riscv/ibex_irq.h"
+#include "migration/vmstate.h"
 #include "trace.h"
 
 /* clang-format off */
@@ -244,7 +245,7 @@ static uint64_t ot_timer_read(void *opaque, hwaddr addr, unsigned size)
         break;
     }
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_TIMER_IO_READ_OUT);
     trace_ot_timer_io_read_out(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32,
                                pc);
 
@@ -260,7 +261,7 @@ static void ot_timer_write(void *opaque, hwaddr addr, uint64_t value,
 
     hwaddr reg = R32_OFF(addr);
 
-    uint32_t pc = ibex_get_current_pc();
+    uint32_t pc = ibex_get_current_pc_if(TRACE_OT_TIMER_IO_WRITE);
     trace_ot_timer_io_write(s->ot_id, (uint32_t)addr, REG_NAME(reg), val32, pc);
 
     switch (reg) {
@@ -356,6 +357,21 @@ static Property ot_timer_properties[] = {
     DEFINE_PROP_END_OF_LIST(),
 };
 
+static const VMStateDescription vmstate_ot_timer = {
+    .name = TYPE_OT_TIMER,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32_ARRAY(regs, OtTimerState, REGS_COUNT),
+        VMSTATE_INT64(origin_ns, OtTimerState),
+        VMSTATE_TIMER_PTR(timer, OtTimerState),
+        VMSTATE_IBEX_IRQ(m_timer_irq, OtTimerState),
+        VMSTATE_IBEX_IRQ(irq, OtTimerState),
+        VMSTATE_IBEX_IRQ(alert, OtTimerState),
+        VMSTATE_END_OF_LIST(),
+    },
+};
+
 static void ot_timer_reset(DeviceState *dev)
 {
     OtTimerState *s = OT_TIMER(dev);
@@ -406,6 +422,7 @@ static void ot_timer_class_init(ObjectClass *klass, void *data)
 
     dc->reset = &ot_timer_reset;
     dc->realize = &ot_timer_realize;
+    dc->vmsd = &vmstate_ot_timer;
     device_class_set_props(dc, ot_timer_properties);
 }
 
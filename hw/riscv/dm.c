@@ -47,8 +47,12 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/bswap.h"
 #include "qemu/compiler.h"
 #include "qemu/log.h"
+#include "qemu/main-loop.h"
+#include "qemu/rcu.h"
+#include "qemu/timer.h"
 #include "qemu/typedefs.h"
 #include "qapi/error.h"
 #include "disas/dis-asm.h"
@@ -256,6 +260,12 @@ static_assert((A_LAST - A_FIRST) < 64u, "too many registers");
 
 #define RISCVDM_DEFAULT_MTA 0x1ull /* "MEMTXATTRS_UNSPECIFIED" */
 
+/* Max. count of bytes prefetched from or posted to host memory */
+#define SBA_BURST_SIZE 256u
+
+/* Period of the DMI throughput reports */
+#define DM_STATS_PERIOD_NS NANOSECONDS_PER_SECOND
+
 /*
  * Type definitions
  */
@@ -322,6 +332,14 @@ typedef struct RISCVDMConfig {
     bool enable;
 } RISCVDMConfig;
 
+/** System bus burst buffer */
+typedef struct RISCVDMSysbusBurst {
+    uint8_t buf[SBA_BURST_SIZE];
+    hwaddr address; /* address of the first buffered byte */
+    unsigned length; /* count of valid bytes in buf */
+    unsigned limit; /* count of bytes that may be buffered from address */
+} RISCVDMSysbusBurst;
+
 /** Debug Module */
 struct RISCVDMState {
     RISCVDebugDeviceState parent;
@@ -337,6 +355,14 @@ struct RISCVDMState {
     uint32_t address; /* DM register addr: only bADDRESS_BITS..b0 are used */
     uint32_t *regs; /* Debug module register values */
     uint64_t sbdata; /* Last sysbus data */
+    RISCVDMSysbusBurst sb_prefetch; /* Sysbus data read ahead */
+    RISCVDMSysbusBurst sb_posted; /* Sysbus data pending write */
+    Notifier sb_poll_notifier; /* Main loop iteration, ends sysbus bursts */
+    struct {
+        int64_t start_ns; /* start of the current period */
+        uint64_t dmi_ops; /* DMI requests in the current period */
+        uint64_t sba_bytes; /* Sysbus bytes in the current period */
+    } stats;
     MemTxAttrs mta_dm; /* MemTxAttrs to access debug module implementation */
     MemTxAttrs mta_sba; /* MemTxAttrs to access system bus devices */
     bool cmd_busy; /* A command is being executed */
@@ -386,6 +412,9 @@ struct RISCVDMDMReg {
 
 static void riscv_dm_reset(DeviceState *dev);
 
+static void riscv_dm_update_stats(RISCVDMState *dm);
+static void riscv_dm_sysbus_flush(RISCVDMState *dm);
+
 static bool riscv_dm_cond_autoexec(RISCVDMState *dm, bool prgbf,
                                    unsigned regix);
 static CmdErr riscv_dm_read_absdata(RISCVDMState *dm, unsigned woffset,
@@ -561,6 +590,17 @@ riscv_dm_write_rq(RISCVDebugDeviceState *dev, uint32_t addr, uint32_t value)
     CmdErr ret;
     bool autoexec = false;
 
+    riscv_dm_update_stats(dm);
+
+    /*
+     * Posted sysbus writes are only kept while the debugger streams sysbus
+     * data, any write invalidates the prefetched sysbus data.
+     */
+    if (addr != A_SBDATA0 && addr != A_SBDATA1) {
+        riscv_dm_sysbus_flush(dm);
+    }
+    dm->sb_prefetch.length = 0u;
+
     /* store address for next read back */
     dm->address = addr;
 
@@ -615,6 +655,18 @@ riscv_dm_read_rq(RISCVDebugDeviceState *dev, uint32_t addr)
     bool autoexec = false;
     uint32_t value = 0;
 
+    riscv_dm_update_stats(dm);
+
+    /*
+     * Any read completes the posted sysbus writes, so that errors are
+     * reported. Prefetched sysbus data are only kept while the debugger
+     * streams sysbus data.
+     */
+    riscv_dm_sysbus_flush(dm);
+    if (addr != A_SBDATA0 && addr != A_SBDATA1 && addr != A_SBCS) {
+        dm->sb_prefetch.length = 0u;
+    }
+
     /* store address for next read back */
     dm->address = addr;
 
@@ -1614,6 +1666,201 @@ static void riscv_dm_sysbus_increment_address(RISCVDMState *dm)
     }
 }
 
+static void riscv_dm_update_stats(RISCVDMState *dm)
+{
+    if (!trace_event_get_state(TRACE_RISCV_DM_STATS)) {
+        return;
+    }
+
+    int64_t now = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
+    int64_t elapsed = now - dm->stats.start_ns;
+
+    dm->stats.dmi_ops += 1u;
+
+    if (elapsed < DM_STATS_PERIOD_NS) {
+        return;
+    }
+
+    if (dm->stats.start_ns) {
+        trace_riscv_dm_stats(dm->soc,
+                             dm->stats.dmi_ops * NANOSECONDS_PER_SECOND /
+                                 (uint64_t)elapsed,
+                             dm->stats.sba_bytes * NANOSECONDS_PER_SECOND /
+                                 (uint64_t)elapsed);
+    }
+
+    dm->stats.start_ns = now;
+    dm->stats.dmi_ops = 0u;
+    dm->stats.sba_bytes = 0u;
+}
+
+/*
+ * Tell whether every vCPU of the machine is a hart of this DM, and is halted.
+ * With MTTCG, vCPUs access guest RAM from their own thread, without holding
+ * the BQL, so any running vCPU may update the memory at any time.
+ */
+static bool riscv_dm_all_harts_halted(RISCVDMState *dm)
+{
+    CPUState *cpu;
+    unsigned cpu_count = 0;
+
+    CPU_FOREACH(cpu) {
+        cpu_count++;
+    }
+
+    if (cpu_count != dm->hart_count) {
+        /* some vCPUs are not controlled by this DM */
+        return false;
+    }
+
+    for (unsigned hix = 0; hix < dm->hart_count; hix++) {
+        if (!dm->harts[hix].halted) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Report how many bytes, up to SBA_BURST_SIZE, starting from address can be
+ * accessed in host memory, i.e. without any side effect.
+ * Bursts are only considered while all the harts of the machine are halted,
+ * and only span the DMI requests handled within a single main loop dispatch
+ * (see riscv_dm_sysbus_poll), so that the debugger never gets stale data,
+ * even if a device updates the memory between two DMI sequences.
+ */
+static unsigned
+riscv_dm_sysbus_direct_length(RISCVDMState *dm, hwaddr address, bool is_write)
+{
+    if (!FIELD_EX32(dm->regs[A_SBCS], SBCS, SBAUTOINCREMENT) ||
+        !riscv_dm_all_harts_halted(dm)) {
+        return 0u;
+    }
+
+    RCU_READ_LOCK_GUARD();
+
+    hwaddr xlat;
+    hwaddr len = SBA_BURST_SIZE;
+    MemoryRegion *mr = address_space_translate(dm->as, address, &xlat, &len,
+                                               is_write, dm->mta_sba);
+    if (!memory_access_is_direct(mr, is_write)) {
+        return 0u;
+    }
+
+    return (unsigned)MIN(len, SBA_BURST_SIZE);
+}
+
+/*
+ * Read sysbus data from the prefetch buffer, filling it up from host memory
+ * if the debugger is reading a sequence of words.
+ */
+static bool riscv_dm_sysbus_prefetch(RISCVDMState *dm, hwaddr address,
+                                     uint32_t size, uint64_t *val64)
+{
+    RISCVDMSysbusBurst *sbb = &dm->sb_prefetch;
+
+    if (size > sizeof(uint64_t)) {
+        return false;
+    }
+
+    if (address < sbb->address ||
+        address + size > sbb->address + sbb->length) {
+        sbb->length = 0u;
+
+        if (!FIELD_EX32(dm->regs[A_SBCS], SBCS, SBREADONDATA)) {
+            return false;
+        }
+
+        unsigned length = riscv_dm_sysbus_direct_length(dm, address, false);
+        if (length < size) {
+            return false;
+        }
+
+        if (address_space_read(dm->as, address, dm->mta_sba, sbb->buf,
+                               length) != MEMTX_OK) {
+            return false;
+        }
+
+        sbb->address = address;
+        sbb->length = length;
+        trace_riscv_dm_sysbus_prefetch(dm->soc, address, length);
+    }
+
+    *val64 = ldn_le_p(&sbb->buf[address - sbb->address], (int)size);
+
+    return true;
+}
+
+/*
+ * Post sysbus data to the write buffer if the debugger is writing a sequence
+ * of words to host memory.
+ */
+static bool riscv_dm_sysbus_post_write(RISCVDMState *dm, hwaddr address,
+                                       uint32_t size, uint64_t val64)
+{
+    RISCVDMSysbusBurst *sbb = &dm->sb_posted;
+
+    if (sbb->length && (address != sbb->address + sbb->length ||
+                        sbb->length + size > sbb->limit)) {
+        riscv_dm_sysbus_flush(dm);
+    }
+
+    if (size > sizeof(uint64_t)) {
+        return false;
+    }
+
+    if (!sbb->length) {
+        unsigned limit = riscv_dm_sysbus_direct_length(dm, address, true);
+        if (limit < size) {
+            return false;
+        }
+        sbb->address = address;
+        sbb->limit = limit;
+    }
+
+    stn_le_p(&sbb->buf[sbb->length], (int)size, val64);
+    sbb->length += size;
+
+    return true;
+}
+
+static void riscv_dm_sysbus_flush(RISCVDMState *dm)
+{
+    RISCVDMSysbusBurst *sbb = &dm->sb_posted;
+
+    if (!sbb->length) {
+        return;
+    }
+
+    MemTxResult res = address_space_write(dm->as, sbb->address, dm->mta_sba,
+                                          sbb->buf, sbb->length);
+    trace_riscv_dm_sysbus_flush(dm->soc, sbb->address, sbb->length, res);
+    if (res != MEMTX_OK) {
+        dm->regs[A_SBCS] =
+            FIELD_DP32(dm->regs[A_SBCS], SBCS, SBERROR, SYSBUS_BADADDR);
+        xtrace_riscv_dm_error(dm->soc, "memtx");
+    }
+
+    sbb->length = 0u;
+}
+
+/*
+ * Bursts are only used while all harts are halted, so that the other bus
+ * masters are devices, such as DMA controllers, which run with the BQL held,
+ * and may therefore only access the memory between two main loop dispatches:
+ * complete the posted writes and discard the prefetched data whenever the
+ * main loop iterates.
+ */
+static void riscv_dm_sysbus_poll(Notifier *notifier, void *data)
+{
+    RISCVDMState *dm = container_of(notifier, RISCVDMState, sb_poll_notifier);
+    (void)data;
+
+    riscv_dm_sysbus_flush(dm);
+    dm->sb_prefetch.length = 0u;
+}
+
 static CmdErr riscv_dm_sysbus_read(RISCVDMState *dm)
 {
     uint32_t size;
@@ -1647,7 +1894,12 @@ static CmdErr riscv_dm_sysbus_read(RISCVDMState *dm)
      * contents of the remaining high bits may take on any value
      */
     uint64_t val64 = 0; /* however 0 is easier for debugging */
-    res = address_space_rw(dm->as, address, dm->mta_sba, &val64, size, false);
+    if (riscv_dm_sysbus_prefetch(dm, address, size, &val64)) {
+        res = MEMTX_OK;
+    } else {
+        res =
+            address_space_rw(dm->as, address, dm->mta_sba, &val64, size, false);
+    }
     trace_riscv_dm_sysbus_data_read(dm->soc, address, size, val64, res);
     if (res != MEMTX_OK) {
         dm->regs[A_SBCS] =
@@ -1657,6 +1909,7 @@ static CmdErr riscv_dm_sysbus_read(RISCVDMState *dm)
         goto end;
     }
     dm->sbdata = val64;
+    dm->stats.sba_bytes += size;
 end:
     riscv_dm_sysbus_set_busy(dm, false);
 
@@ -1826,13 +2079,20 @@ static CmdErr riscv_dm_sbdata0_write(RISCVDMState *dm, uint32_t value)
     if (size > sizeof(uint32_t)) {
         val64 = ((uint64_t)dm->regs[A_SBDATA1]) << 32u;
     }
-    res = address_space_rw(dm->as, address, dm->mta_sba, &val64, size, true);
+    if (riscv_dm_sysbus_post_write(dm, address, size, val64)) {
+        res = MEMTX_OK;
+    } else {
+        res =
+            address_space_rw(dm->as, address, dm->mta_sba, &val64, size, true);
+    }
     trace_riscv_dm_sysbus_data_write(dm->soc, address, size, val64, res);
     if (res != MEMTX_OK) {
         dm->regs[A_SBCS] =
             FIELD_DP32(dm->regs[A_SBCS], SBCS, SBERROR, SYSBUS_BADADDR);
         xtrace_riscv_dm_error(dm->soc, "memtx");
         ret = CMD_ERR_BUS;
+    } else {
+        dm->stats.sba_bytes += size;
     }
 end:
     riscv_dm_sysbus_set_busy(dm, false);
@@ -2267,7 +2527,8 @@ static CmdErr riscv_dm_access_memory(RISCVDMState *dm, uint32_t value)
     }
 
     if (aampostinc) {
-        addr += argwidth << 2u; /* convert to bytes */
+        /* "increment arg1 by the number of bytes encoded in aamsize" */
+        addr += size;
         if (riscv_dm_write_absdata(dm, argwidth, argwidth, addr)) {
             xtrace_riscv_dm_error(dm->soc, "address postinc");
         }
@@ -2449,6 +2710,8 @@ static void riscv_dm_internal_reset(RISCVDMState *dm)
 {
     dm->address = 0;
     dm->to_go_bm = 0;
+    dm->sb_prefetch.length = 0u;
+    dm->sb_posted.length = 0u;
 
     riscv_dm_set_busy(dm, false);
 
@@ -2621,6 +2884,9 @@ static void riscv_dm_realize(DeviceState *dev, Error **errp)
 
     dm->mta_dm = ((RISCVDMMemAttrs){ .value = dm->cfg.mta_dm }).attrs;
     dm->mta_sba = ((RISCVDMMemAttrs){ .value = dm->cfg.mta_sba }).attrs;
+
+    dm->sb_poll_notifier.notify = &riscv_dm_sysbus_poll;
+    main_loop_poll_add_notifier(&dm->sb_poll_notifier);
 }
 
 static void riscv_dm_class_init(ObjectClass *klass, void *data)
@@ -1427,8 +1427,11 @@ struct OtDjMachineState {
 
     ResettableState reset;
 
+    Notifier machine_done;
+    Error *migration_blocker;
     bool no_epmp_cfg;
     bool ignore_elf_entry;
+    bool partial_migration;
 };
 
 /* ------------------------------------------------------------------------ */
@@ -1877,6 +1880,23 @@ ot_dj_machine_set_ignore_elf_entry(Object *obj, bool value, Error **errp)
     s->ignore_elf_entry = value;
 }
 
+static bool ot_dj_machine_get_partial_migration(Object *obj, Error **errp)
+{
+    OtDjMachineState *s = RISCV_OT_DJ_MACHINE(obj);
+    (void)errp;
+
+    return s->partial_migration;
+}
+
+static void
+ot_dj_machine_set_partial_migration(Object *obj, bool value, Error **errp)
+{
+    OtDjMachineState *s = RISCV_OT_DJ_MACHINE(obj);
+    (void)errp;
+
+    s->partial_migration = value;
+}
+
 static void ot_dj_machine_transitional_reset(Object *obj)
 {
     (void)obj;
@@ -1912,10 +1932,36 @@ static void ot_dj_machine_instance_init(Object *obj)
                              &ot_dj_machine_set_ignore_elf_entry);
     object_property_set_description(obj, "ignore-elf-entry",
                                     "Do not set vCPU PC with ELF entry point");
+    object_property_add_bool(obj, "x-partial-migration",
+                             &ot_dj_machine_get_partial_migration,
+                             &ot_dj_machine_set_partial_migration);
+    object_property_set_description(
+        obj, "x-partial-migration",
+        "Allow migration although some devices do not save their state");
+}
+
+static void ot_dj_machine_done(Notifier *notifier, void *data)
+{
+    OtDjMachineState *s =
+        container_of(notifier, OtDjMachineState, machine_done);
+    (void)data;
+
+    /* containers, and placeholders for unimplemented devices */
+    static const char *const stateless_types[] = {
+        TYPE_RISCV_OT_DJ_BOARD,
+        TYPE_RISCV_OT_DJ_SOC,
+        TYPE_UNIMPLEMENTED_DEVICE,
+        NULL,
+    };
+
+    /* devices created from the command line are also checked */
+    ot_common_block_unmigratable_devices(&s->migration_blocker, OBJECT(s),
+                                         stateless_types);
 }
 
 static void ot_dj_machine_init(MachineState *state)
 {
+    OtDjMachineState *s = RISCV_OT_DJ_MACHINE(state);
     DeviceState *dev = qdev_new(TYPE_RISCV_OT_DJ_BOARD);
 
     object_property_add_child(OBJECT(state), "board", OBJECT(dev));
@@ -1927,6 +1973,11 @@ static void ot_dj_machine_init(MachineState *state)
     qemu_register_reset(resettable_cold_reset_fn, dev);
 
     qdev_realize(dev, NULL, &error_fatal);
+
+    if (!s->partial_migration) {
+        s->machine_done.notify = &ot_dj_machine_done;
+        qemu_add_machine_init_done_notifier(&s->machine_done);
+    }
 }
 
 static void ot_dj_machine_class_init(ObjectClass *oc, void *data)
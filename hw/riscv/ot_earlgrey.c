@@ -1072,8 +1072,11 @@ struct OtEGBoardState {
 struct OtEGMachineState {
     MachineState parent_obj;
 
+    Notifier machine_done;
+    Error *migration_blocker;
     bool no_epmp_cfg;
     bool ignore_elf_entry;
+    bool partial_migration;
 };
 
 /* ------------------------------------------------------------------------ */
@@ -1415,6 +1418,23 @@ ot_eg_machine_set_ignore_elf_entry(Object *obj, bool value, Error **errp)
     s->ignore_elf_entry = value;
 }
 
+static bool ot_eg_machine_get_partial_migration(Object *obj, Error **errp)
+{
+    OtEGMachineState *s = RISCV_OT_EG_MACHINE(obj);
+    (void)errp;
+
+    return s->partial_migration;
+}
+
+static void
+ot_eg_machine_set_partial_migration(Object *obj, bool value, Error **errp)
+{
+    OtEGMachineState *s = RISCV_OT_EG_MACHINE(obj);
+    (void)errp;
+
+    s->partial_migration = value;
+}
+
 static void ot_eg_machine_instance_init(Object *obj)
 {
     OtEGMachineState *s = RISCV_OT_EG_MACHINE(obj);
@@ -1429,14 +1449,45 @@ static void ot_eg_machine_instance_init(Object *obj)
                              &ot_eg_machine_set_ignore_elf_entry);
     object_property_set_description(obj, "ignore-elf-entry",
                                     "Do not set vCPU PC with ELF entry point");
+    object_property_add_bool(obj, "x-partial-migration",
+                             &ot_eg_machine_get_partial_migration,
+                             &ot_eg_machine_set_partial_migration);
+    object_property_set_description(
+        obj, "x-partial-migration",
+        "Allow migration although some devices do not save their state");
+}
+
+static void ot_eg_machine_done(Notifier *notifier, void *data)
+{
+    OtEGMachineState *s =
+        container_of(notifier, OtEGMachineState, machine_done);
+    (void)data;
+
+    /* containers, and placeholders for unimplemented devices */
+    static const char *const stateless_types[] = {
+        TYPE_RISCV_OT_EG_BOARD,
+        TYPE_RISCV_OT_EG_SOC,
+        TYPE_UNIMPLEMENTED_DEVICE,
+        NULL,
+    };
+
+    /* devices created from the command line are also checked */
+    ot_common_block_unmigratable_devices(&s->migration_blocker, OBJECT(s),
+                                         stateless_types);
 }
 
 static void ot_eg_machine_init(MachineState *state)
 {
+    OtEGMachineState *s = RISCV_OT_EG_MACHINE(state);
     DeviceState *dev = qdev_new(TYPE_RISCV_OT_EG_BOARD);
 
     object_property_add_child(OBJECT(state), "board", OBJECT(dev));
     qdev_realize(dev, NULL, &error_fatal);
+
+    if (!s->partial_migration) {
+        s->machine_done.notify = &ot_eg_machine_done;
+        qemu_add_machine_init_done_notifier(&s->machine_done);
+    }
 }
 
 static void ot_eg_machine_class_init(ObjectClass *oc, void *data)
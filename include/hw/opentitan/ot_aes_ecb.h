@@ -0,0 +1,86 @@
+/*
+ * QEMU OpenTitan AES ECB block cipher helper
+ *
+ * Copyright (c) 2024 Rivos, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef HW_OPENTITAN_OT_AES_ECB_H
+#define HW_OPENTITAN_OT_AES_ECB_H
+
+#include "crypto/aes.h"
+#include "crypto/aes-round.h"
+
+#define OT_AES_ECB_BLOCK_SIZE 16u
+
+/*
+ * Expanded AES encryption or decryption key.
+ *
+ * Round keys are expanded once, when the key is set, and stored in the layout
+ * expected by the host AES round primitives, which use the host AES
+ * instructions whenever available.
+ */
+typedef struct {
+    AESState rk[AES_MAXNR + 1u];
+    unsigned rounds;
+} OtAESEcbKey;
+
+/**
+ * Expand an AES encryption key.
+ *
+ * @key the key to initialize
+ * @secret the AES secret key
+ * @size the size of the secret key in bytes, i.e. 16, 24 or 32 bytes
+ */
+void ot_aes_ecb_set_key(OtAESEcbKey *key, const uint8_t *secret, size_t size);
+
+/**
+ * Expand an AES decryption key.
+ *
+ * @key the key to initialize
+ * @secret the AES secret key
+ * @size the size of the secret key in bytes, i.e. 16, 24 or 32 bytes
+ */
+void ot_aes_ecb_set_decrypt_key(OtAESEcbKey *key, const uint8_t *secret,
+                                size_t size);
+
+/**
+ * Encrypt one or more AES blocks in ECB mode.
+ *
+ * @key the expanded key
+ * @in the plain text blocks
+ * @out the cipher text blocks, may be the same buffer as @in
+ * @count the count of 16-byte blocks to encrypt
+ */
+void ot_aes_ecb_encrypt(const OtAESEcbKey *key, const uint8_t *in,
+                        uint8_t *out, unsigned count);
+
+/**
+ * Decrypt one or more AES blocks in ECB mode.
+ *
+ * @key the expanded decryption key
+ * @in the cipher text blocks
+ * @out the plain text blocks, may be the same buffer as @in
+ * @count the count of 16-byte blocks to decrypt
+ */
+void ot_aes_ecb_decrypt(const OtAESEcbKey *key, const uint8_t *in,
+                        uint8_t *out, unsigned count);
+
+#endif /* HW_OPENTITAN_OT_AES_ECB_H */
@@ -35,6 +35,6 @@ OBJECT_DECLARE_SIMPLE_TYPE(OtASTEgState, OT_AST_EG)
 
 #define OT_AST_EG_RANDOM_4BIT_RATE 50000u /* 50 kHz */
 
-void ot_ast_eg_getrandom(void *buf, size_t len);
+void ot_ast_eg_getrandom(OtASTEgState *s, void *buf, size_t len);
 
 #endif /* HW_OPENTITAN_OT_AST_EG_H */
@@ -25,6 +25,7 @@
 
 #include "chardev/char.h"
 #include "exec/memory.h"
+#include "qemu/timer.h"
 #include "hw/core/cpu.h"
 #include "hw/riscv/ibex_common.h"
 
@@ -35,6 +36,49 @@
 /* QEMU virtual timer to use for OpenTitan devices */
 #define OT_VIRTUAL_CLOCK QEMU_CLOCK_VIRTUAL
 
+/*
+ * Poll loop tracker.
+ *
+ * Many device operations complete on a QEMU virtual timer deadline, while the
+ * guest firmware busy-waits on a status register. A device may attach such a
+ * tracker to its completion timer and report each status register read: once
+ * the same vCPU instruction has polled the same register several times in a
+ * row while the completion timer is pending, the timer deadline is brought
+ * forward to the current virtual time, so that the vCPU does not burn host
+ * cycles until the deadline is reached.
+ *
+ * The virtual clock is not advanced: the device operation completes earlier
+ * in guest time than it would otherwise, which changes the guest-visible
+ * timing, in icount mode as well. Devices should therefore only report reads
+ * when explicitly enabled, see their "fast-poll" property.
+ */
+typedef struct {
+    QEMUTimer *timer; /* device timer whose expiry updates the status */
+    hwaddr addr; /* last polled register address */
+    uint32_t pc; /* PC of the last polling instruction */
+    unsigned count; /* count of consecutive identical polls */
+} OtPollWatch;
+
+/**
+ * Initialize a poll loop tracker.
+ *
+ * @pw the tracker to initialize
+ * @timer the device timer to bring forward on poll loop detection
+ */
+void ot_common_poll_watch_init(OtPollWatch *pw, QEMUTimer *timer);
+
+/**
+ * Report a status register read from a device MMIO handler.
+ * This should only be called when the fast poll feature of the device is
+ * enabled.
+ *
+ * @pw the poll loop tracker
+ * @id the device identifier, for tracing purposes
+ * @addr the address of the polled register
+ * @return @c true if the timer deadline has been brought forward
+ */
+bool ot_common_poll_watch(OtPollWatch *pw, const char *id, hwaddr addr);
+
 /* ------------------------------------------------------------------------ */
 /* Multi-bit boolean values */
 /* ------------------------------------------------------------------------ */
@@ -282,6 +326,23 @@ unsigned ot_common_check_rom_configuration(void);
  */
 AddressSpace *ot_common_get_local_address_space(DeviceState *s);
 
+/**
+ * Prevent the machine from being migrated or snapshotted if any device below
+ * the specified object does not describe its state for migration.
+ * Should be called once all devices have been created, i.e. from a machine
+ * init done notifier, so that devices created from the command line are also
+ * checked.
+ *
+ * @blocker the storage for the migration blocker, which should outlive the
+ *          machine; a single blocker is added whatever the number of calls
+ * @root the object whose descendant devices are checked, usually the machine
+ * @stateless_types NULL-terminated list of device types without any state,
+ *                  such as container devices, which are not checked; their
+ *                  own descendants are checked
+ */
+void ot_common_block_unmigratable_devices(Error **blocker, Object *root,
+                                          const char *const *stateless_types);
+
 /* ------------------------------------------------------------------------ */
 /* CharDev utilities */
 /* ------------------------------------------------------------------------ */
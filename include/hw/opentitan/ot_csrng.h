@@ -29,6 +29,7 @@
 #define HW_OPENTITAN_OT_CSRNG_H
 
 #include "qom/object.h"
+#include "exec/hwaddr.h"
 #include "hw/registerfields.h"
 
 #define TYPE_OT_CSRNG "ot-csrng"
@@ -123,4 +124,17 @@ int ot_csrng_request_entropy(OtCSRNGState *s, unsigned app_id);
 int ot_csrng_push_command(OtCSRNGState *s, unsigned app_id,
                           const uint32_t *command);
 
+/**
+ * Report a guest read of a status register that reflects the completion of
+ * CSRNG commands, either the CSRNG one or the one of a HW application.
+ * When the CSRNG "fast-poll" property is enabled and a poll loop is detected,
+ * a command waiting for entropy is retried right away.
+ *
+ * @s the CSRNG device
+ * @dev the device whose status register is polled
+ * @addr the address of the polled register
+ */
+void ot_csrng_report_status_poll(OtCSRNGState *s, DeviceState *dev,
+                                 hwaddr addr);
+
 #endif /* HW_OPENTITAN_OT_CSRNG_H */
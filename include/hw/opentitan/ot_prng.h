@@ -36,6 +36,7 @@ OtPrngState *ot_prng_allocate(void);
 void ot_prng_release(OtPrngState *prng);
 uint32_t ot_prng_random_u32(OtPrngState *prng);
 void ot_prng_random_u32_array(OtPrngState *prng, uint32_t *array, size_t count);
+void ot_prng_random_buffer(OtPrngState *prng, void *buf, size_t len);
 void ot_prng_reseed(OtPrngState *prng, uint32_t seed);
 void ot_prng_reseed_array(OtPrngState *prng, const uint32_t *seed,
                           size_t length);
@@ -27,6 +27,7 @@
 #include "exec/hwaddr.h"
 #include "hw/qdev-core.h"
 #include "hw/sysbus.h"
+#include "trace/control.h"
 
 /* ------------------------------------------------------------------------ */
 /* PMP configuration */
@@ -509,6 +510,16 @@ uint32_t ibex_load_kernel(CPUState *cpu);
  */
 uint32_t ibex_get_current_pc(void);
 
+/*
+ * Report the current guest PC only if the trace event that consumes it is
+ * enabled, so that MMIO handlers do not pay for the vCPU PC retrieval when
+ * tracing is off. Evaluates to 0 otherwise.
+ *
+ * @_ev_ the trace event identifier, i.e. TRACE_<EVENT_NAME>
+ */
+#define ibex_get_current_pc_if(_ev_) \
+    (trace_event_get_state(_ev_) ? ibex_get_current_pc() : 0u)
+
 /*
  * Helper for device debugging: report the current guest CPU index, if any.
  *
@@ -29,6 +29,7 @@
 #include "hw/irq.h"
 #include "hw/qdev-core.h"
 #include "hw/sysbus.h"
+#include "migration/vmstate.h"
 
 /** Simple IRQ wrapper to limit propagation of no-change calls */
 typedef struct {
@@ -36,6 +37,13 @@ typedef struct {
     int level;
 } IbexIRQ;
 
+/*
+ * Only the cached output level is saved: the state of the IRQ sink is
+ * restored by the sink device itself.
+ */
+#define VMSTATE_IBEX_IRQ(_field_, _state_) \
+    VMSTATE_INT32(_field_.level, _state_)
+
 static inline bool ibex_irq_is_connected(const IbexIRQ *ibex_irq)
 {
     return qemu_irq_is_connected(ibex_irq->irq);
@@ -11,6 +11,7 @@
 from argparse import ArgumentParser, FileType, Namespace
 from atexit import register
 from collections import defaultdict, deque
+from concurrent.futures import ThreadPoolExecutor, as_completed
 from csv import reader as csv_reader, writer as csv_writer
 from fnmatch import fnmatchcase
 from glob import glob
@@ -23,13 +24,19 @@ def hjload(*_, **__):  # noqa: E301
         """dummy func if HJSON module is not available"""
         return {}
 from os import close, curdir, environ, getcwd, linesep, pardir, sep, unlink
+try:
+    from os import sched_getaffinity, sched_setaffinity
+except ImportError:
+    # CPU affinity is only available on some hosts, such as Linux
+    sched_getaffinity = sched_setaffinity = None
 from os.path import (abspath, basename, dirname, exists, isabs, isdir, isfile,
                      join as joinpath, normpath, relpath)
 from select import POLLIN, POLLERR, POLLHUP, poll as spoll
 from shutil import rmtree
 from socket import socket, timeout as LegacyTimeoutError
 from subprocess import Popen, PIPE, TimeoutExpired
-from threading import Event, Thread
+from queue import SimpleQueue
+from threading import Event, Lock, Thread
 from tempfile import mkdtemp, mkstemp
 from time import time as now
 from traceback import format_exc
@@ -229,6 +236,8 @@ def run(self, tdef: EasyDict[str, Any]) -> tuple[int, ExecTime, str]:
                            defined as a regular expression.
                 - start_delay, the delay to wait before starting the execution
                            of the context once QEMU command has been started.
+                - cpus, an optional set of host CPUs the QEMU process should
+                           be pinned to
            :return: a 3-uple of exit code, execution time, and last guest error
         """
         # stdout and stderr belongs to QEMU VM
@@ -264,6 +273,11 @@ def trig_match(bline):
         try:
             workdir = dirname(tdef.command[0])
             log.debug('Executing QEMU as %s', ' '.join(tdef.command))
+            if tdef.get('cpus'):
+                # CPU affinity is a per-thread attribute on Linux, which is
+                # inherited by child processes: pin the calling thread so that
+                # QEMU and all its threads are pinned from their creation.
+                sched_setaffinity(0, tdef.cpus)
             # pylint: disable=consider-using-with
             proc = Popen(tdef.command, bufsize=1, cwd=workdir, stdout=PIPE,
                          stderr=PIPE, encoding='utf-8', errors='ignore',
@@ -725,20 +739,27 @@ def create_eflash_image(self, app: Optional[str] = None,
             gen.close()
         return flash_file
 
-    def create_otp_image(self, vmem: str) -> str:
+    def create_otp_image(self, vmem: str, worker: Optional[int] = None) -> str:
         """Generate a temporary OTP image file.
 
            If a temporary file has already been generated for the input VMEM
-           file, use it instead.
+           file and is still in use, use it instead. As QEMU updates the OTP
+           image file, the file should be released with delete_otp_image once
+           the QEMU instance using it has completed, so that the next instance
+           starts with the original OTP content.
 
            :param vmem: path to the VMEM source file
+           :param worker: optional worker identifier, as QEMU updates the OTP
+                          image file, concurrent QEMU instances should never
+                          share the same OTP image file
            :return: the full path to the temporary OTP file
         """
         # pylint: disable=import-outside-toplevel
-        if vmem in self._otp_files:
-            otp_file, ref_count = self._otp_files[vmem]
+        otp_key = vmem if worker is None else f'{vmem}#{worker}'
+        if otp_key in self._otp_files:
+            otp_file, ref_count = self._otp_files[otp_key]
             self._log.debug('Use existing %s', basename(otp_file))
-            self._otp_files[vmem] = (otp_file, ref_count + 1)
+            self._otp_files[otp_key] = (otp_file, ref_count + 1)
             return otp_file
         from otptool import OtpImage
         otp = OtpImage()
@@ -751,7 +772,7 @@ def create_otp_image(self, vmem: str) -> str:
         close(otp_fd)
         with open(otp_file, 'wb') as rfp:
             otp.save_raw(rfp)
-        self._otp_files[vmem] = (otp_file, 1)
+        self._otp_files[otp_key] = (otp_file, 1)
         return otp_file
 
     def delete_flash_image(self, filename: str) -> None:
@@ -762,6 +783,8 @@ def delete_flash_image(self, filename: str) -> None:
         if not isfile(filename):
             self._log.warning('No such flash image file %s', basename(filename))
             return
+        if self._keep_temp:
+            return
         self._log.debug('Delete flash image file %s', basename(filename))
         unlink(filename)
         self._in_fly.discard(filename)
@@ -777,18 +800,21 @@ def delete_otp_image(self, filename: str) -> None:
         if not isfile(filename):
             self._log.warning('No such OTP image file %s', basename(filename))
             return
-        for vmem, (raw, count) in self._otp_files.items():
+        for otp_key, (raw, count) in self._otp_files.items():
             if raw != filename:
                 continue
             count -= 1
             if not count:
-                self._log.debug('Delete OTP image file %s', basename(filename))
-                unlink(filename)
-                self._in_fly.discard(filename)
-                del self._otp_files[vmem]
+                # a kept file is never reused, as its content may have changed
+                if not self._keep_temp:
+                    self._log.debug('Delete OTP image file %s',
+                                    basename(filename))
+                    unlink(filename)
+                    self._in_fly.discard(filename)
+                del self._otp_files[otp_key]
             else:
                 self._log.debug('Keep OTP image file %s', basename(filename))
-                self._otp_files[vmem] = (raw, count)
+                self._otp_files[otp_key] = (raw, count)
             break
 
     def _configure_logger(self, tool) -> None:
@@ -1170,6 +1196,7 @@ def __init__(self, qfm: QEMUFileManager, config: dict[str, any],
         self._argdict: dict[str, Any] = {}
         self._qemu_cmd: list[str] = []
         self._suffixes = []
+        self._build_lock = Lock()
         if hasattr(self._args, 'opts'):
             setattr(self._args, 'global_opts', getattr(self._args, 'opts'))
             setattr(self._args, 'opts', [])
@@ -1237,53 +1264,22 @@ def run(self, debug: bool, allow_no_test: bool) -> int:
             if not tcount and not allow_no_test:
                 self._log.error('No test can be run')
                 return 1
-            targs = None
-            temp_files = {}
-            for tpos, test in enumerate(tests, start=1):
-                self._log.info('[TEST %s] (%d/%d)', self.get_test_radix(test),
-                               tpos, tcount)
-                try:
-                    self._qfm.define_transient({
-                        'UTPATH': test,
-                        'UTDIR': normpath(dirname(test)),
-                        'UTFILE': basename(test),
-                    })
-                    test_name = self.get_test_radix(test)
-                    exec_info = self._build_qemu_test_command(test)
-                    exec_info.test_name = test_name
-                    exec_info.context.execute('pre')
-                    tret, xtime, err = qot.run(exec_info)
-                    cret = exec_info.context.finalize()
-                    if exec_info.expect_result != 0:
-                        if tret == exec_info.expect_result:
-                            self._log.info('QEMU failed with expected error, '
-                                           'assume success')
-                            tret = 0
-                        elif tret == 0:
-                            self._log.warning('QEMU success while expected '
-                                              'error %d, assume error', tret)
-                            tret = 98
-                    if tret == 0 and cret != 0:
-                        tret = 99
-                    if tret and not err:
-                        err = exec_info.context.first_error
-                    exec_info.context.execute('post', tret)
-                # pylint: disable=broad-except
-                except Exception as exc:
-                    self._log.critical('%s', str(exc))
-                    if debug:
-                        print(format_exc(chain=False), file=sys.stderr)
-                    tret = 99
-                    xtime = 0.0
-                    err = str(exc)
-                finally:
-                    self._qfm.cleanup_transient()
+            jobs = min(max(1, int(self._argdict.get('jobs') or 1)),
+                       max(1, tcount))
+            if jobs > 1:
+                fixed = [name for name in map(self.get_test_radix, tests)
+                         if self._use_fixed_tcp_ports(name)]
+                if fixed:
+                    self._log.error('Tests that use fixed TCP ports cannot '
+                                    'run concurrently: %s', ', '.join(fixed))
+                    return 1
+                results_it = self._run_parallel_tests(qot, tests, jobs, debug)
+            else:
+                results_it = (self._run_test(qot, test, tpos, tcount, debug)
+                              for tpos, test in enumerate(tests, start=1))
+            for test_name, tret, xtime, icount, err in results_it:
                 results[tret] += 1
                 sret = self.RESULT_MAP.get(tret, tret)
-                if targs:
-                    icount = self.get_namespace_arg(targs, 'icount')
-                else:
-                    icount = None
                 if csv:
                     csv.writerow(TestResult(test_name, sret, xtime, icount,
                                             err))
@@ -1293,7 +1289,6 @@ def run(self, debug: bool, allow_no_test: bool) -> int:
                 else:
                     self._log.info('"%s" executed in %s (%s)',
                                    test_name, xtime, sret)
-                self._cleanup_temp_files(temp_files)
         finally:
             if cfp:
                 cfp.close()
@@ -1311,6 +1306,141 @@ def run(self, debug: bool, allow_no_test: bool) -> int:
                        self.RESULT_MAP.get(ret, ret))
         return ret
 
+    def _run_test(self, qot: QEMUWrapper, test: str, tpos: int, tcount: int,
+                  debug: bool, worker: Optional[int] = None,
+                  cpus: Optional[set[int]] = None) \
+            -> tuple[str, int, ExecTime, Optional[str], str]:
+        """Execute a single test.
+
+           :param qot: the QEMU wrapper
+           :param test: the test to execute
+           :param tpos: the test position in the test list
+           :param tcount: the count of tests to execute
+           :param debug: whether running in debug mode
+           :param worker: the worker identifier, when tests run concurrently
+           :param cpus: the host CPUs to pin QEMU to, if any
+           :return: the test name, the result, execution time, icount and
+                    error message
+        """
+        # pylint: disable=too-many-arguments
+        test_name = self.get_test_radix(test)
+        self._log.info('[TEST %s] (%d/%d)', test_name, tpos, tcount)
+        exec_info = None
+        try:
+            # file manager interpolation relies on shared transient variables
+            with self._build_lock:
+                try:
+                    self._qfm.define_transient({
+                        'UTPATH': test,
+                        'UTDIR': normpath(dirname(test)),
+                        'UTFILE': basename(test),
+                    })
+                    exec_info = self._build_qemu_test_command(test, worker)
+                finally:
+                    self._qfm.cleanup_transient()
+            exec_info.test_name = test_name
+            exec_info.cpus = cpus
+            exec_info.context.execute('pre')
+            tret, xtime, err = qot.run(exec_info)
+            cret = exec_info.context.finalize()
+            if exec_info.expect_result != 0:
+                if tret == exec_info.expect_result:
+                    self._log.info('QEMU failed with expected error, '
+                                   'assume success')
+                    tret = 0
+                elif tret == 0:
+                    self._log.warning('QEMU success while expected '
+                                      'error %d, assume error', tret)
+                    tret = 98
+            if tret == 0 and cret != 0:
+                tret = 99
+            if tret and not err:
+                err = exec_info.context.first_error
+            exec_info.context.execute('post', tret)
+        # pylint: disable=broad-except
+        except Exception as exc:
+            self._log.critical('%s', str(exc))
+            if debug:
+                print(format_exc(chain=False), file=sys.stderr)
+            tret = 99
+            xtime = 0.0
+            err = str(exc)
+        if exec_info:
+            # QEMU updates the OTP image file, never reuse it for another test
+            with self._build_lock:
+                self._cleanup_temp_files(exec_info.tmpfiles)
+        return test_name, tret, xtime, None, err
+
+    def _run_parallel_tests(self, qot: QEMUWrapper, tests: list[str],
+                            jobs: int, debug: bool) \
+            -> Iterator[tuple[str, int, ExecTime, Optional[str], str]]:
+        """Execute tests concurrently.
+
+           Each concurrent QEMU instance is assigned a worker identifier, which
+           is used to allocate distinct virtual COM port TCP ports and OTP
+           image files, and a distinct subset of the host CPUs if CPU affinity
+           is supported.
+
+           :param qot: the QEMU wrapper
+           :param tests: the tests to execute
+           :param jobs: the count of concurrent QEMU instances
+           :param debug: whether running in debug mode
+           :return: an iterator on test results, in completion order
+        """
+        worker_cpus: list[Optional[set[int]]] = [None] * jobs
+        if sched_getaffinity:
+            host_cpus = sorted(sched_getaffinity(0))
+            cpu_count = len(host_cpus) // jobs
+            if cpu_count:
+                for wid in range(jobs):
+                    worker_cpus[wid] = \
+                        set(host_cpus[wid*cpu_count:(wid+1)*cpu_count])
+            else:
+                self._log.warning('Not enough host CPUs for %d jobs, '
+                                  'CPU affinity disabled', jobs)
+        workers = SimpleQueue()
+        for wid in range(jobs):
+            workers.put(wid)
+
+        def run_test(tpos: int, test: str):
+            wid = workers.get()
+            try:
+                return self._run_test(qot, test, tpos, len(tests), debug, wid,
+                                      worker_cpus[wid])
+            finally:
+                workers.put(wid)
+
+        self._log.info('Execute tests with %d concurrent jobs', jobs)
+        with ThreadPoolExecutor(max_workers=jobs,
+                                thread_name_prefix='pyot') as executor:
+            futures = [executor.submit(run_test, tpos, test)
+                       for tpos, test in enumerate(tests, start=1)]
+            for future in as_completed(futures):
+                yield future.result()
+
+    def _use_fixed_tcp_ports(self, test_name: str) -> bool:
+        """Tell whether a test configuration uses hard-coded TCP ports, which
+           are not offset per worker as the virtual COM ports are.
+
+           :param test_name: the test name
+           :return: True if the QEMU options or the context commands of the
+                    test define a TCP port
+        """
+        tests_cfg = self._config.get('tests', {})
+        test_cfg = tests_cfg.get(test_name) if isinstance(tests_cfg, dict) \
+            else None
+        if not isinstance(test_cfg, dict):
+            return False
+        items = []
+        for entry in ('opts', 'pre', 'with', 'post'):
+            value = test_cfg.get(entry)
+            if isinstance(value, list):
+                items.extend(str(v) for v in value)
+            elif value:
+                items.append(str(value))
+        port_re = re.compile(r'\bport=\d+|\btcp:[\w.-]*:\d+')
+        return any(port_re.search(item) for item in items)
+
     def get_test_radix(self, filename: str) -> str:
         """Extract the radix name from a test pathname.
 
@@ -1362,8 +1492,6 @@ def guess_test_type(filepath: str) -> str:
         return 'bin'
 
     def _cleanup_temp_files(self, storage: dict[str, set[str]]) -> None:
-        if self._qfm.keep_temporary:
-            return
         for kind, files in storage.items():
             delete_file = getattr(self._qfm, f'delete_{kind}_image')
             for filename in files:
@@ -1471,6 +1599,8 @@ def _build_qemu_vcp_args(self, args: Namespace) -> \
             raise ValueError(f'Invalid TCP serial device: {device}') from exc
         mux = f'mux={"on" if args.muxserial else "off"}'
         vcps = args.vcp or [self.DEFAULT_SERIAL_PORT]
+        # concurrent QEMU instances use distinct TCP port ranges
+        port += (getattr(args, 'worker', None) or 0) * len(vcps)
         vcp_args = ['-display', 'none']
         vcp_map = {}
         for vix, vcp in enumerate(vcps):
@@ -1504,7 +1634,8 @@ def _build_qemu_command(self, args: Namespace,
         if args.otp:
             if not isfile(args.otp):
                 raise ValueError(f'No such OTP file: {args.otp}')
-            otp_file = self._qfm.create_otp_image(args.otp)
+            otp_file = self._qfm.create_otp_image(args.otp,
+                                                  getattr(args, 'worker', None))
             temp_files['otp'].add(otp_file)
             qemu_args.extend(('-drive',
                               f'if=pflash,file={otp_file},format=raw'))
@@ -1563,10 +1694,13 @@ def _build_qemu_command(self, args: Namespace,
                         tmpfiles=temp_files, start_delay=start_delay,
                         trigger=trigger)
 
-    def _build_qemu_test_command(self, filename: str) -> EasyDict[str, Any]:
+    def _build_qemu_test_command(self, filename: str,
+                                 worker: Optional[int] = None) \
+            -> EasyDict[str, Any]:
         test_name = self.get_test_radix(filename)
         args, opts, timeout, texp = self._build_test_args(test_name)
         setattr(args, 'exec', filename)
+        setattr(args, 'worker', worker)
         exec_info = self._build_qemu_command(args, opts)
         exec_info.pop('connection', None)
         exec_info.args = args
@@ -1832,6 +1966,9 @@ def main():
         exe.add_argument('-F', '--filter', metavar='TEST', action='append',
                          help='run tests with matching filter, prefix with "!" '
                               'to exclude matching tests')
+        exe.add_argument('-j', '--jobs', metavar='JOBS', type=int,
+                         help='run up to JOBS tests concurrently '
+                              '(default: 1)')
         exe.add_argument('-k', '--timeout', metavar='SECONDS', type=float,
                          help=f'exit after the specified seconds '
                               f'(default: {DEFAULT_TIMEOUT} secs)')
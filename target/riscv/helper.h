@@ -124,10 +124,10 @@ DEF_HELPER_2(cbo_inval, void, env, tl)
 DEF_HELPER_2(cbo_zero, void, env, tl)
 
 /* Special functions */
-DEF_HELPER_2(csrr, tl, env, int)
+DEF_HELPER_FLAGS_2(csrr, TCG_CALL_NO_WG, tl, env, int)
 DEF_HELPER_3(csrw, void, env, int, tl)
 DEF_HELPER_4(csrrw, tl, env, int, tl, tl)
-DEF_HELPER_2(csrr_i128, tl, env, int)
+DEF_HELPER_FLAGS_2(csrr_i128, TCG_CALL_NO_WG, tl, env, int)
 DEF_HELPER_4(csrw_i128, void, env, int, tl, tl)
 DEF_HELPER_6(csrrw_i128, tl, env, int, tl, tl, tl, tl)
 #ifndef CONFIG_USER_ONLY
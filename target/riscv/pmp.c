@@ -187,6 +187,7 @@ void pmp_unlock_entries(CPURISCVState *env)
     for (i = 0; i < pmp_num; i++) {
         env->pmp_state.pmp[i].cfg_reg &= ~(PMP_LOCK | PMP_AMATCH);
     }
+    env->pmp_state.map_valid = false;
 }
 
 static void pmp_decode_napot(hwaddr a, hwaddr *sa, hwaddr *ea)
@@ -249,6 +250,7 @@ void pmp_update_rule_addr(CPURISCVState *env, uint32_t pmp_index)
 
     env->pmp_state.addr[pmp_index].sa = sa;
     env->pmp_state.addr[pmp_index].ea = ea;
+    env->pmp_state.map_valid = false;
 }
 
 void pmp_update_rule_nums(CPURISCVState *env)
@@ -263,6 +265,7 @@ void pmp_update_rule_nums(CPURISCVState *env)
             env->pmp_state.num_rules++;
         }
     }
+    env->pmp_state.map_valid = false;
 }
 
 static int pmp_is_in_range(CPURISCVState *env, int pmp_index, hwaddr addr)
@@ -279,6 +282,102 @@ static int pmp_is_in_range(CPURISCVState *env, int pmp_index, hwaddr addr)
     return result;
 }
 
+static int pmp_compare_bounds(const void *a, const void *b)
+{
+    hwaddr ha = *(const hwaddr *)a;
+    hwaddr hb = *(const hwaddr *)b;
+
+    return (ha > hb) - (ha < hb);
+}
+
+/*
+ * Rebuild the decision map.
+ * The address space is split into disjoint intervals, at each boundary of
+ * the active rules. Each interval records the highest priority rule that
+ * matches it, so that a lookup does not need to walk all the rules. Adjacent
+ * intervals matched by the same rule are merged.
+ */
+static void pmp_update_map(CPURISCVState *env)
+{
+    pmp_table_t *pt = &env->pmp_state;
+    hwaddr bounds[2 * MAX_RISCV_PMPS + 1];
+    unsigned count = 0;
+    int i;
+
+    bounds[count++] = 0u;
+    for (i = 0; i < MAX_RISCV_PMPS; i++) {
+        if (pmp_get_a_field(pt->pmp[i].cfg_reg) == PMP_AMATCH_OFF) {
+            continue;
+        }
+        bounds[count++] = pt->addr[i].sa;
+        if (pt->addr[i].ea != (hwaddr)-1) {
+            bounds[count++] = pt->addr[i].ea + 1u;
+        }
+    }
+
+    qsort(bounds, count, sizeof(hwaddr), &pmp_compare_bounds);
+
+    pt->map_len = 0;
+    for (unsigned bx = 0; bx < count; bx++) {
+        if (bx && bounds[bx] == bounds[bx - 1u]) {
+            continue;
+        }
+
+        int rule = -1;
+        for (i = 0; i < MAX_RISCV_PMPS; i++) {
+            if (pmp_get_a_field(pt->pmp[i].cfg_reg) != PMP_AMATCH_OFF &&
+                pmp_is_in_range(env, i, bounds[bx])) {
+                rule = i;
+                break;
+            }
+        }
+
+        if (pt->map_len && pt->map[pt->map_len - 1u].rule == rule) {
+            continue;
+        }
+
+        pt->map[pt->map_len].sa = bounds[bx];
+        pt->map[pt->map_len].rule = rule;
+        pt->map_len++;
+    }
+
+    pt->map_valid = true;
+}
+
+/*
+ * Find the decision map entry an address belongs to.
+ */
+static unsigned pmp_map_lookup(CPURISCVState *env, hwaddr addr)
+{
+    pmp_table_t *pt = &env->pmp_state;
+
+    if (!pt->map_valid) {
+        pmp_update_map(env);
+    }
+
+    /* first entry always starts at 0 */
+    unsigned lo = 0;
+    unsigned hi = pt->map_len - 1u;
+    while (lo < hi) {
+        unsigned mid = (lo + hi + 1u) / 2u;
+        if (pt->map[mid].sa <= addr) {
+            lo = mid;
+        } else {
+            hi = mid - 1u;
+        }
+    }
+
+    return lo;
+}
+
+/*
+ * Get the highest priority rule matching an address, or -1 if none.
+ */
+static int pmp_find_rule(CPURISCVState *env, hwaddr addr)
+{
+    return env->pmp_state.map[pmp_map_lookup(env, addr)].rule;
+}
+
 /*
  * Check if the address has required RWX privs when no PMP entry is matched.
  */
@@ -348,8 +447,8 @@ bool pmp_hart_has_privs(CPURISCVState *env, hwaddr addr,
 {
     int i = 0;
     int pmp_size = 0;
-    hwaddr s = 0;
-    hwaddr e = 0;
+    int s = -1;
+    int e = -1;
 
     /* Short cut if no rules */
     if (0 == pmp_get_num_rules(env)) {
@@ -372,125 +471,118 @@ bool pmp_hart_has_privs(CPURISCVState *env, hwaddr addr,
 
     /*
      * 1.10 draft priv spec states there is an implicit order
-     * from low to high
+     * from low to high: the decision map gives the highest priority rule
+     * matching each end of the access.
      */
-    for (i = 0; i < MAX_RISCV_PMPS; i++) {
-        s = pmp_is_in_range(env, i, addr);
-        e = pmp_is_in_range(env, i, addr + pmp_size - 1);
+    s = pmp_find_rule(env, addr);
+    e = pmp_find_rule(env, addr + pmp_size - 1);
 
-        /* partially inside */
-        if ((s + e) == 1) {
-            qemu_log_mask(LOG_GUEST_ERROR,
-                          "pmp violation at 0x" HWADDR_FMT_plx "+" TARGET_FMT_lu
-                          " - access is partially inside pmp[%u]\n",
-                          addr, size, i);
-            *allowed_privs = 0;
-            return false;
-        }
+    /* partially inside */
+    if (s != e) {
+        qemu_log_mask(LOG_GUEST_ERROR,
+                      "pmp violation at 0x" HWADDR_FMT_plx "+" TARGET_FMT_lu
+                      " - access is partially inside pmp[%u]\n",
+                      addr, size, (s < 0 || (e >= 0 && e < s)) ? e : s);
+        *allowed_privs = 0;
+        return false;
+    }
 
-        /* fully inside */
-        const uint8_t a_field =
-            pmp_get_a_field(env->pmp_state.pmp[i].cfg_reg);
+    /* No rule matched */
+    if (s < 0) {
+        return pmp_hart_has_privs_default(env, privs, allowed_privs, mode);
+    }
 
-        if (((s + e) == 2) && (PMP_AMATCH_OFF != a_field)) {
-            /*
-             * If the PMP entry is not off and the address is in range,
-             * do the priv check
-             */
-            if (!MSECCFG_MML_ISSET(env)) {
-                /*
-                 * If mseccfg.MML Bit is not set, do pmp priv check
-                 * This will always apply to regular PMP.
-                 */
+    /* fully inside: the PMP entry is not off, do the priv check */
+    i = s;
+    if (!MSECCFG_MML_ISSET(env)) {
+        /*
+         * If mseccfg.MML Bit is not set, do pmp priv check
+         * This will always apply to regular PMP.
+         */
+        *allowed_privs = PMP_READ | PMP_WRITE | PMP_EXEC;
+        if ((mode != PRV_M) || pmp_is_locked(env, i)) {
+            *allowed_privs &= env->pmp_state.pmp[i].cfg_reg;
+        }
+    } else {
+        /*
+         * If mseccfg.MML Bit set, do the enhanced pmp priv check
+         */
+        const uint8_t epmp_operation =
+            pmp_get_epmp_operation(env->pmp_state.pmp[i].cfg_reg);
+
+        if (mode == PRV_M) {
+            switch (epmp_operation) {
+            case 0:
+            case 1:
+            case 4:
+            case 5:
+            case 6:
+            case 7:
+            case 8:
+                *allowed_privs = 0;
+                break;
+            case 2:
+            case 3:
+            case 14:
+                *allowed_privs = PMP_READ | PMP_WRITE;
+                break;
+            case 9:
+            case 10:
+                *allowed_privs = PMP_EXEC;
+                break;
+            case 11:
+            case 13:
+                *allowed_privs = PMP_READ | PMP_EXEC;
+                break;
+            case 12:
+            case 15:
+                *allowed_privs = PMP_READ;
+                break;
+            default:
+                g_assert_not_reached();
+            }
+        } else {
+            switch (epmp_operation) {
+            case 0:
+            case 8:
+            case 9:
+            case 12:
+            case 13:
+            case 14:
+                *allowed_privs = 0;
+                break;
+            case 1:
+            case 10:
+            case 11:
+                *allowed_privs = PMP_EXEC;
+                break;
+            case 2:
+            case 4:
+            case 15:
+                *allowed_privs = PMP_READ;
+                break;
+            case 3:
+            case 6:
+                *allowed_privs = PMP_READ | PMP_WRITE;
+                break;
+            case 5:
+                *allowed_privs = PMP_READ | PMP_EXEC;
+                break;
+            case 7:
                 *allowed_privs = PMP_READ | PMP_WRITE | PMP_EXEC;
-                if ((mode != PRV_M) || pmp_is_locked(env, i)) {
-                    *allowed_privs &= env->pmp_state.pmp[i].cfg_reg;
-                }
-            } else {
-                /*
-                 * If mseccfg.MML Bit set, do the enhanced pmp priv check
-                 */
-                const uint8_t epmp_operation =
-                    pmp_get_epmp_operation(env->pmp_state.pmp[i].cfg_reg);
-
-                if (mode == PRV_M) {
-                    switch (epmp_operation) {
-                    case 0:
-                    case 1:
-                    case 4:
-                    case 5:
-                    case 6:
-                    case 7:
-                    case 8:
-                        *allowed_privs = 0;
-                        break;
-                    case 2:
-                    case 3:
-                    case 14:
-                        *allowed_privs = PMP_READ | PMP_WRITE;
-                        break;
-                    case 9:
-                    case 10:
-                        *allowed_privs = PMP_EXEC;
-                        break;
-                    case 11:
-                    case 13:
-                        *allowed_privs = PMP_READ | PMP_EXEC;
-                        break;
-                    case 12:
-                    case 15:
-                        *allowed_privs = PMP_READ;
-                        break;
-                    default:
-                        g_assert_not_reached();
-                    }
-                } else {
-                    switch (epmp_operation) {
-                    case 0:
-                    case 8:
-                    case 9:
-                    case 12:
-                    case 13:
-                    case 14:
-                        *allowed_privs = 0;
-                        break;
-                    case 1:
-                    case 10:
-                    case 11:
-                        *allowed_privs = PMP_EXEC;
-                        break;
-                    case 2:
-                    case 4:
-                    case 15:
-                        *allowed_privs = PMP_READ;
-                        break;
-                    case 3:
-                    case 6:
-                        *allowed_privs = PMP_READ | PMP_WRITE;
-                        break;
-                    case 5:
-                        *allowed_privs = PMP_READ | PMP_EXEC;
-                        break;
-                    case 7:
-                        *allowed_privs = PMP_READ | PMP_WRITE | PMP_EXEC;
-                        break;
-                    default:
-                        g_assert_not_reached();
-                    }
-                }
+                break;
+            default:
+                g_assert_not_reached();
             }
-
-            /*
-             * If matching address range was found, the protection bits
-             * defined with PMP must be used. We shouldn't fallback on
-             * finding default privileges.
-             */
-            return (privs & *allowed_privs) == privs;
         }
     }
 
-    /* No rule matched */
-    return pmp_hart_has_privs_default(env, privs, allowed_privs, mode);
+    /*
+     * If matching address range was found, the protection bits
+     * defined with PMP must be used. We shouldn't fallback on
+     * finding default privileges.
+     */
+    return (privs & *allowed_privs) == privs;
 }
 
 /*
@@ -671,11 +763,8 @@ target_ulong mseccfg_csr_read(CPURISCVState *env)
  */
 target_ulong pmp_get_tlb_size(CPURISCVState *env, hwaddr addr)
 {
-    hwaddr pmp_sa;
-    hwaddr pmp_ea;
     hwaddr tlb_sa = addr & ~(TARGET_PAGE_SIZE - 1);
     hwaddr tlb_ea = tlb_sa + TARGET_PAGE_SIZE - 1;
-    int i;
 
     /*
      * If PMP is not supported or there are no PMP rules, the TLB page will not
@@ -686,37 +775,20 @@ target_ulong pmp_get_tlb_size(CPURISCVState *env, hwaddr addr)
         return TARGET_PAGE_SIZE;
     }
 
-    for (i = 0; i < MAX_RISCV_PMPS; i++) {
-        if (pmp_get_a_field(env->pmp_state.pmp[i].cfg_reg) == PMP_AMATCH_OFF) {
-            continue;
-        }
-
-        pmp_sa = env->pmp_state.addr[i].sa;
-        pmp_ea = env->pmp_state.addr[i].ea;
-
-        /*
-         * Only the first PMP entry that covers (whole or partial of) the TLB
-         * page really matters:
-         * If it covers the whole TLB page, set the size to TARGET_PAGE_SIZE,
-         * since the following PMP entries have lower priority and will not
-         * affect the permissions of the page.
-         * If it only covers partial of the TLB page, set the size to 1 since
-         * the allowed permissions of the region may be different from other
-         * region of the page.
-         */
-        if (pmp_sa <= tlb_sa && pmp_ea >= tlb_ea) {
-            return TARGET_PAGE_SIZE;
-        } else if ((pmp_sa >= tlb_sa && pmp_sa <= tlb_ea) ||
-                   (pmp_ea >= tlb_sa && pmp_ea <= tlb_ea)) {
-            return 1;
-        }
-    }
-
     /*
-     * If no PMP entry matches the TLB page, the TLB page will also not be
-     * split into regions with different permissions by PMP so we set the size
-     * to TARGET_PAGE_SIZE.
+     * Only the highest priority PMP entry that covers (whole or partial of)
+     * each byte of the TLB page really matters: if the same decision map
+     * entry, i.e. the same PMP entry or no PMP entry at all, applies to the
+     * whole TLB page, the page is not split into regions with different
+     * permissions, so set the size to TARGET_PAGE_SIZE. Otherwise, set the
+     * size to 1 since the allowed permissions of the regions may differ.
      */
+    unsigned ix = pmp_map_lookup(env, tlb_sa);
+    if (ix + 1u < env->pmp_state.map_len &&
+        env->pmp_state.map[ix + 1u].sa <= tlb_ea) {
+        return 1;
+    }
+
     return TARGET_PAGE_SIZE;
 }
 
@@ -59,10 +59,23 @@ typedef struct {
     hwaddr ea;
 } pmp_addr_t;
 
+/*
+ * Decision map entry: the address interval starting at sa and ending right
+ * before the start of the next map entry is matched by the rule, if any.
+ */
+typedef struct {
+    hwaddr sa;
+    int rule; /* highest priority matching rule, or -1 if none */
+} pmp_map_entry_t;
+
 typedef struct {
     pmp_entry_t pmp[MAX_RISCV_PMPS];
     pmp_addr_t  addr[MAX_RISCV_PMPS];
     uint32_t num_rules;
+    /* sorted decision map, rebuilt on demand after any rule update */
+    pmp_map_entry_t map[2 * MAX_RISCV_PMPS + 1];
+    uint32_t map_len;
+    bool map_valid;
 } pmp_table_t;
 
 void pmpcfg_csr_write(CPURISCVState *env, uint32_t reg_index,
@@ -115,6 +115,9 @@ typedef struct DisasContext {
     /* FRM is known to contain a valid value. */
     bool frm_valid;
     bool insn_start_updated;
+    /* Translation continues at jmp_dest rather than the next insn */
+    bool jmp_inline;
+    target_ulong jmp_dest;
     const GPtrArray *decoders;
 } DisasContext;
 
@@ -557,6 +560,27 @@ static void gen_set_fpr_d(DisasContext *ctx, int reg_num, TCGv_i64 t)
     }
 }
 
+/*
+ * Whether a direct jump may be followed within the current TB, so that the
+ * blocks on both sides of the jump are optimized as a single superblock.
+ * Only forward jumps that stay in the first page of the TB are followed:
+ * the TB byte range then still covers every translated instruction, so
+ * that any write to the guest code invalidates the TB as usual.
+ */
+static bool can_inline_jump(DisasContext *ctx, target_long diff)
+{
+    target_ulong dest = ctx->base.pc_next + diff;
+
+    if (ctx->itrigger || ctx->base.singlestep_enabled ||
+        ctx->base.plugin_enabled ||
+        (tb_cflags(ctx->base.tb) & CF_NO_GOTO_TB)) {
+        return false;
+    }
+
+    return diff >= (target_long)ctx->cur_insn_len &&
+           is_same_page(&ctx->base, dest);
+}
+
 static void gen_jal(DisasContext *ctx, int rd, target_ulong imm)
 {
     TCGv succ_pc = dest_gpr(ctx, rd);
@@ -574,6 +598,12 @@ static void gen_jal(DisasContext *ctx, int rd, target_ulong imm)
     gen_pc_plus_diff(succ_pc, ctx, ctx->cur_insn_len);
     gen_set_gpr(ctx, rd, succ_pc);
 
+    if (can_inline_jump(ctx, imm)) {
+        ctx->jmp_inline = true;
+        ctx->jmp_dest = ctx->base.pc_next + imm;
+        return;
+    }
+
     gen_goto_tb(ctx, 0, imm); /* must use this for safety */
     ctx->base.is_jmp = DISAS_NORETURN;
 }
@@ -1242,6 +1272,7 @@ static void riscv_tr_init_disas_context(DisasContextBase *dcbase, CPUState *cs)
     ctx->itrigger = FIELD_EX32(tb_flags, TB_FLAGS, ITRIGGER);
     ctx->zero = tcg_constant_tl(0);
     ctx->virt_inst_excp = false;
+    ctx->jmp_inline = false;
     ctx->decoders = cpu->decoders;
 }
 
@@ -1270,7 +1301,12 @@ static void riscv_tr_translate_insn(DisasContextBase *dcbase, CPUState *cpu)
 
     ctx->ol = ctx->xl;
     decode_opc(env, ctx, opcode16);
-    ctx->base.pc_next += ctx->cur_insn_len;
+    if (ctx->jmp_inline) {
+        ctx->jmp_inline = false;
+        ctx->base.pc_next = ctx->jmp_dest;
+    } else {
+        ctx->base.pc_next += ctx->cur_insn_len;
+    }
 
     if (unlikely(ctx->base.singlestep_enabled)) {
         ctx->base.is_jmp = DISAS_SSTEP;
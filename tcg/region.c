@@ -72,6 +72,8 @@ struct tcg_region_state {
     /* fields protected by the lock */
     size_t current; /* current region index */
     size_t agg_size_full; /* aggregate size of full regions */
+    uint64_t *seq; /* per-region allocation sequence, 0 if free */
+    uint64_t last_seq; /* last allocation sequence */
 };
 
 static struct tcg_region_state region;
@@ -191,10 +193,23 @@ static void tcg_region_trees_init(void)
     }
 }
 
-static struct tcg_region_tree *tc_ptr_to_region_tree(const void *p)
+/* @p must be a rw pointer within code_gen_buffer */
+static size_t tcg_region_index(const void *p)
 {
-    size_t region_idx;
+    ptrdiff_t offset;
+
+    if (p < region.start_aligned) {
+        return 0;
+    }
+    offset = p - region.start_aligned;
+    if (offset > region.stride * (region.n - 1)) {
+        return region.n - 1;
+    }
+    return offset / region.stride;
+}
 
+static struct tcg_region_tree *tc_ptr_to_region_tree(const void *p)
+{
     /*
      * Like tcg_splitwx_to_rw, with no assert.  The pc may come from
      * a signal handler over which the caller has no control.
@@ -206,18 +221,7 @@ static struct tcg_region_tree *tc_ptr_to_region_tree(const void *p)
         }
     }
 
-    if (p < region.start_aligned) {
-        region_idx = 0;
-    } else {
-        ptrdiff_t offset = p - region.start_aligned;
-
-        if (offset > region.stride * (region.n - 1)) {
-            region_idx = region.n - 1;
-        } else {
-            region_idx = offset / region.stride;
-        }
-    }
-    return region_trees + region_idx * tree_size;
+    return region_trees + tcg_region_index(p) * tree_size;
 }
 
 void tcg_tb_insert(TranslationBlock *tb)
@@ -359,11 +363,21 @@ static void tcg_region_assign(TCGContext *s, size_t curr_region)
 
 static bool tcg_region_alloc__locked(TCGContext *s)
 {
-    if (region.current == region.n) {
-        return true;
+    size_t i;
+
+    if (region.current < region.n) {
+        i = region.current++;
+    } else {
+        /* all regions have been used once: reuse an evicted one, if any */
+        for (i = 0; i < region.n && region.seq[i]; i++) {
+            continue;
+        }
+        if (i == region.n) {
+            return true;
+        }
     }
-    tcg_region_assign(s, region.current);
-    region.current++;
+    tcg_region_assign(s, i);
+    region.seq[i] = ++region.last_seq;
     return false;
 }
 
@@ -412,6 +426,8 @@ void tcg_region_reset_all(void)
     qemu_mutex_lock(&region.lock);
     region.current = 0;
     region.agg_size_full = 0;
+    memset(region.seq, 0, region.n * sizeof(*region.seq));
+    region.last_seq = 0;
 
     for (i = 0; i < n_ctxs; i++) {
         TCGContext *s = qatomic_read(&tcg_ctxs[i]);
@@ -422,6 +438,66 @@ void tcg_region_reset_all(void)
     tcg_region_tree_reset_all();
 }
 
+/*
+ * Release the least recently allocated region that no TCG context is
+ * generating code into, so that it can be allocated again. @func is
+ * called on each TB of the region before its tree is emptied, which lets
+ * the caller unlink and invalidate them.
+ * Returns false if there is no region that can be evicted.
+ * Call from a safe-work context.
+ */
+bool tcg_region_evict(GTraverseFunc func, gpointer user_data)
+{
+    unsigned int n_ctxs = qatomic_read(&tcg_cur_ctxs);
+    struct tcg_region_tree *rt;
+    size_t victim = region.n;
+    void *start, *end;
+    unsigned int i;
+    size_t j;
+
+    qemu_mutex_lock(&region.lock);
+    for (j = 0; j < region.n; j++) {
+        if (!region.seq[j]) {
+            continue;
+        }
+        for (i = 0; i < n_ctxs; i++) {
+            const TCGContext *s = qatomic_read(&tcg_ctxs[i]);
+
+            if (tcg_region_index(s->code_gen_buffer) == j) {
+                break;
+            }
+        }
+        if (i < n_ctxs) {
+            /* region is in use */
+            continue;
+        }
+        if (victim == region.n || region.seq[j] < region.seq[victim]) {
+            victim = j;
+        }
+    }
+    qemu_mutex_unlock(&region.lock);
+
+    if (victim == region.n) {
+        return false;
+    }
+
+    rt = region_trees + victim * tree_size;
+    qemu_mutex_lock(&rt->lock);
+    q_tree_foreach(rt->tree, func, user_data);
+    /* Increment the refcount first so that destroy acts as a reset */
+    q_tree_ref(rt->tree);
+    q_tree_destroy(rt->tree);
+    qemu_mutex_unlock(&rt->lock);
+
+    tcg_region_bounds(victim, &start, &end);
+    qemu_mutex_lock(&region.lock);
+    region.seq[victim] = 0;
+    region.agg_size_full -= end - start - TCG_HIGHWATER;
+    qemu_mutex_unlock(&region.lock);
+
+    return true;
+}
+
 static size_t tcg_n_regions(size_t tb_size, unsigned max_cpus)
 {
 #ifdef CONFIG_USER_ONLY
@@ -435,9 +511,14 @@ static size_t tcg_n_regions(size_t tb_size, unsigned max_cpus)
      * being of reasonable size. If that's not possible we make do by evenly
      * dividing the code_gen_buffer among the vCPUs.
      */
-    /* Use a single region if all we have is one vCPU thread */
+    /*
+     * With a single vCPU thread, still split the buffer in a few regions
+     * so that a full buffer can be recycled one region at a time rather
+     * than flushed altogether.
+     */
     if (max_cpus == 1 || !qemu_tcg_mttcg_enabled()) {
-        return 1;
+        n_regions = tb_size / (16 * MiB);
+        return MAX(MIN(n_regions, 8), 1);
     }
 
     /*
@@ -850,6 +931,7 @@ void tcg_region_init(size_t tb_size, int splitwx, unsigned max_cpus)
         }
     }
 
+    region.seq = g_new0(uint64_t, region.n);
     tcg_region_trees_init();
 
     /*
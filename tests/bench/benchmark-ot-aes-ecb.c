@@ -0,0 +1,111 @@
+/*
+ * QEMU OpenTitan AES ECB helper speed benchmark
+ *
+ * Copyright (c) 2024 Rivos, Inc.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or
+ * (at your option) any later version.  See the COPYING file in the
+ * top-level directory.
+ */
+#include "qemu/osdep.h"
+#include "qemu/units.h"
+#include "hw/opentitan/ot_aes_ecb.h"
+
+/*
+ * CSRNG encrypts three blocks per CTR_DRBG update, and the AES device one
+ * block per guest request: measure small batches as well as large ones.
+ */
+static void test_ot_aes_ecb_speed(size_t key_size, unsigned blocks)
+{
+    OtAESEcbKey enc_key;
+    OtAESEcbKey dec_key;
+    uint8_t secret[32u];
+    size_t chunk_size = blocks * OT_AES_ECB_BLOCK_SIZE;
+    const size_t total = 256 * MiB;
+    size_t remain;
+
+    memset(secret, g_test_rand_int(), sizeof(secret));
+    uint8_t *buf = g_new0(uint8_t, chunk_size);
+    memset(buf, g_test_rand_int(), chunk_size);
+
+    ot_aes_ecb_set_key(&enc_key, secret, key_size);
+    ot_aes_ecb_set_decrypt_key(&dec_key, secret, key_size);
+
+    g_test_timer_start();
+    for (remain = total; remain >= chunk_size; remain -= chunk_size) {
+        ot_aes_ecb_encrypt(&enc_key, buf, buf, blocks);
+    }
+    g_test_timer_elapsed();
+
+    g_test_message("enc(aes-%zu) %u blocks/call %.2f MB/sec", key_size * 8u,
+                   blocks, (double)total / MiB / g_test_timer_last());
+
+    g_test_timer_start();
+    for (remain = total; remain >= chunk_size; remain -= chunk_size) {
+        ot_aes_ecb_decrypt(&dec_key, buf, buf, blocks);
+    }
+    g_test_timer_elapsed();
+
+    g_test_message("dec(aes-%zu) %u blocks/call %.2f MB/sec", key_size * 8u,
+                   blocks, (double)total / MiB / g_test_timer_last());
+
+    g_free(buf);
+}
+
+static void test_ot_aes_ecb_key_speed(size_t key_size)
+{
+    OtAESEcbKey key;
+    uint8_t secret[32u];
+    const unsigned count = 1000000u;
+
+    memset(secret, g_test_rand_int(), sizeof(secret));
+
+    /* CSRNG expands a new key on each CTR_DRBG update */
+    g_test_timer_start();
+    for (unsigned ix = 0; ix < count; ix++) {
+        secret[0u] = (uint8_t)ix;
+        ot_aes_ecb_set_key(&key, secret, key_size);
+    }
+    g_test_timer_elapsed();
+
+    g_test_message("key(aes-%zu) %.2f Mkeys/sec", key_size * 8u,
+                   (double)count / 1e6 / g_test_timer_last());
+}
+
+static void test_speed_128_1(void)
+{
+    test_ot_aes_ecb_speed(16u, 1u);
+}
+
+static void test_speed_256_1(void)
+{
+    test_ot_aes_ecb_speed(32u, 1u);
+}
+
+static void test_speed_256_3(void)
+{
+    test_ot_aes_ecb_speed(32u, 3u);
+}
+
+static void test_speed_256_64(void)
+{
+    test_ot_aes_ecb_speed(32u, 64u);
+}
+
+static void test_key_speed_256(void)
+{
+    test_ot_aes_ecb_key_speed(32u);
+}
+
+int main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/ot-aes-ecb/aes-128/blocks-1", test_speed_128_1);
+    g_test_add_func("/ot-aes-ecb/aes-256/blocks-1", test_speed_256_1);
+    g_test_add_func("/ot-aes-ecb/aes-256/blocks-3", test_speed_256_3);
+    g_test_add_func("/ot-aes-ecb/aes-256/blocks-64", test_speed_256_64);
+    g_test_add_func("/ot-aes-ecb/aes-256/key", test_key_speed_256);
+
+    return g_test_run();
+}
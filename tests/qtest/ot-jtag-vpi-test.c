@@ -0,0 +1,165 @@
+/*
+ * QTest testcase for the JTAG VPI transport of the OpenTitan TAP controller
+ *
+ * Scan vectors are sent as OpenOCD jtag_vpi commands to read the TAP IDCODE,
+ * then to read a RISC-V Debug Module register through the DTM DMI register.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "qemu/osdep.h"
+#include <glib/gstdio.h>
+#include <sys/socket.h>
+#include "qemu/bswap.h"
+#include "libqtest.h"
+
+/* EarlGrey TAP identifier: lowRISC, part 0, TAP 1, version 0 */
+#define EG_TAP_IDCODE 0x00001cdfu
+
+#define TAP_IR_LENGTH 5u
+#define TAP_IR_DMI    0x11u
+
+#define DTM_ABITS   7u
+#define DMI_LENGTH  (DTM_ABITS + 32u + 2u)
+#define DMI_NOP     0u
+#define DMI_READ    1u
+#define DMI_WRITE   2u
+#define DM_CONTROL  0x10u
+#define DM_STATUS   0x11u
+
+#define VPI_XFERT_MAX_SIZE 512u
+#define VPI_CMD_OFFSET     0u
+#define VPI_OUT_OFFSET     (VPI_CMD_OFFSET + sizeof(uint32_t))
+#define VPI_IN_OFFSET      (VPI_OUT_OFFSET + VPI_XFERT_MAX_SIZE)
+#define VPI_LENGTH_OFFSET  (VPI_IN_OFFSET + VPI_XFERT_MAX_SIZE)
+#define VPI_NB_BITS_OFFSET (VPI_LENGTH_OFFSET + sizeof(uint32_t))
+#define VPI_CMD_SIZE       (VPI_NB_BITS_OFFSET + sizeof(uint32_t))
+
+enum {
+    VPI_CMD_RESET,
+    VPI_CMD_TMS_SEQ,
+    VPI_CMD_SCAN_CHAIN,
+    VPI_CMD_SCAN_CHAIN_FLIP_TMS,
+};
+
+/* TMS sequences, LSB first */
+#define TMS_RESET_TO_SHIFT_DR  0x2u /* 0, 1, 0, 0 */
+#define TMS_EXIT1_TO_SHIFT_IR  0xdu /* 1, 0, 1, 1, 0, 0 */
+#define TMS_EXIT1_TO_SHIFT_DR  0x5u /* 1, 0, 1, 0, 0 */
+
+static void vpi_send(int fd, const uint8_t *cmd)
+{
+    size_t pos = 0;
+    while (pos < VPI_CMD_SIZE) {
+        ssize_t len = send(fd, &cmd[pos], VPI_CMD_SIZE - pos, 0);
+        g_assert_cmpint(len, >, 0);
+        pos += (size_t)len;
+    }
+}
+
+static void vpi_recv(int fd, uint8_t *cmd)
+{
+    size_t pos = 0;
+    while (pos < VPI_CMD_SIZE) {
+        ssize_t len = recv(fd, &cmd[pos], VPI_CMD_SIZE - pos, 0);
+        g_assert_cmpint(len, >, 0);
+        pos += (size_t)len;
+    }
+}
+
+static void vpi_tms(int fd, uint32_t tms, unsigned nb_bits)
+{
+    uint8_t cmd[VPI_CMD_SIZE] = { 0 };
+
+    stl_le_p(&cmd[VPI_CMD_OFFSET], VPI_CMD_TMS_SEQ);
+    for (unsigned ix = 0; ix < nb_bits; ix += 8u) {
+        cmd[VPI_OUT_OFFSET + ix / 8u] = (uint8_t)(tms >> ix);
+    }
+    stl_le_p(&cmd[VPI_LENGTH_OFFSET], DIV_ROUND_UP(nb_bits, 8u));
+    stl_le_p(&cmd[VPI_NB_BITS_OFFSET], nb_bits);
+    vpi_send(fd, cmd);
+}
+
+/* shift a vector into DR or IR, leave the shift state on the last bit */
+static uint64_t vpi_scan(int fd, uint64_t tdi, unsigned nb_bits)
+{
+    uint8_t cmd[VPI_CMD_SIZE] = { 0 };
+
+    stl_le_p(&cmd[VPI_CMD_OFFSET], VPI_CMD_SCAN_CHAIN_FLIP_TMS);
+    for (unsigned ix = 0; ix < nb_bits; ix += 8u) {
+        cmd[VPI_OUT_OFFSET + ix / 8u] = (uint8_t)(tdi >> ix);
+    }
+    stl_le_p(&cmd[VPI_LENGTH_OFFSET], DIV_ROUND_UP(nb_bits, 8u));
+    stl_le_p(&cmd[VPI_NB_BITS_OFFSET], nb_bits);
+    vpi_send(fd, cmd);
+
+    vpi_recv(fd, cmd);
+    uint64_t tdo = 0;
+    for (unsigned ix = 0; ix < nb_bits; ix += 8u) {
+        tdo |= ((uint64_t)cmd[VPI_IN_OFFSET + ix / 8u]) << ix;
+    }
+
+    return tdo & ((1ull << nb_bits) - 1u);
+}
+
+static uint64_t dmi_scan(int fd, uint32_t addr, uint32_t data, unsigned op)
+{
+    uint64_t dmi = ((uint64_t)addr << 34u) | ((uint64_t)data << 2u) | op;
+    uint64_t res = vpi_scan(fd, dmi, DMI_LENGTH);
+    /* update the DMI register, then go back to Shift-DR */
+    vpi_tms(fd, TMS_EXIT1_TO_SHIFT_DR, 5u);
+
+    return res;
+}
+
+static void test_vpi_scan(void)
+{
+    g_autofree char *tmpdir = g_dir_make_tmp("ot-jtag-vpi-XXXXXX", NULL);
+    g_autofree char *path = g_strdup_printf("%s/tap.sock", tmpdir);
+
+    int sock = qtest_socket_server(path);
+    QTestState *qts =
+        qtest_initf("-machine ot-earlgrey "
+                    "-chardev socket,id=taprbb,path=%s "
+                    "-global tap-ctrl-rbb.vpi=on",
+                    path);
+    int fd = accept(sock, NULL, NULL);
+    g_assert_cmpint(fd, >=, 0);
+
+    uint8_t cmd[VPI_CMD_SIZE] = { 0 };
+    stl_le_p(&cmd[VPI_CMD_OFFSET], VPI_CMD_RESET);
+    vpi_send(fd, cmd);
+
+    /* IDCODE is the default instruction after a TAP reset */
+    vpi_tms(fd, TMS_RESET_TO_SHIFT_DR, 4u);
+    g_assert_cmphex(vpi_scan(fd, 0, 32u), ==, EG_TAP_IDCODE);
+
+    /* select the DTM DMI register */
+    vpi_tms(fd, TMS_EXIT1_TO_SHIFT_IR, 6u);
+    vpi_scan(fd, TAP_IR_DMI, TAP_IR_LENGTH);
+    vpi_tms(fd, TMS_EXIT1_TO_SHIFT_DR, 5u);
+
+    /* activate the DM, request DMSTATUS, then collect the read result */
+    dmi_scan(fd, DM_CONTROL, 0x1u, DMI_WRITE);
+    dmi_scan(fd, DM_STATUS, 0, DMI_READ);
+    uint64_t res = dmi_scan(fd, 0, 0, DMI_NOP);
+
+    g_assert_cmphex(res & 0x3u, ==, 0u); /* no DMI error */
+    g_assert_cmphex((uint32_t)(res >> 34u), ==, DM_STATUS);
+    g_assert_cmphex((uint32_t)(res >> 2u) & 0xfu, ==, 2u); /* DM v0.13 */
+
+    close(fd);
+    close(sock);
+    qtest_quit(qts);
+    g_unlink(path);
+    g_rmdir(tmpdir);
+}
+
+int main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+
+    qtest_add_func("/ot-jtag-vpi-test/scan", test_vpi_scan);
+
+    return g_test_run();
+}
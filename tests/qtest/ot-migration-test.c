@@ -0,0 +1,146 @@
+/*
+ * QTest testcase for the migration of OpenTitan EarlGrey machine devices
+ *
+ * Only the devices that describe their state for migration are checked: the
+ * machine is started with the x-partial-migration property, as it would
+ * otherwise refuse to be migrated.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "qemu/osdep.h"
+#include <glib/gstdio.h>
+#include "libqtest.h"
+#include "migration-helpers.h"
+
+#define OT_TIMER_BASE     0x40100000u
+#define OT_AON_TIMER_BASE 0x40470000u
+
+#define TIMER_CTRL             0x004u
+#define TIMER_INTR_ENABLE0     0x100u
+#define TIMER_INTR_STATE0      0x104u
+#define TIMER_CFG0             0x10cu
+#define TIMER_COMPARE_LOWER0_0 0x118u
+#define TIMER_COMPARE_UPPER0_0 0x11cu
+
+#define AON_TIMER_WKUP_THOLD      0x08u
+#define AON_TIMER_WDOG_BARK_THOLD 0x18u
+#define AON_TIMER_WDOG_BITE_THOLD 0x1cu
+
+static void test_blocker(void)
+{
+    QTestState *qts = qtest_init("-machine ot-earlgrey");
+    g_autofree char *tmpdir = g_dir_make_tmp("ot-migration-XXXXXX", NULL);
+    g_autofree char *path = g_strdup_printf("%s/vmstate", tmpdir);
+    g_autofree char *uri = g_strdup_printf("file:%s", path);
+
+    /* most devices do not describe their state: migration is refused */
+    migrate_qmp_fail(qts, uri, NULL, "{}");
+
+    qtest_quit(qts);
+    g_unlink(path);
+    g_rmdir(tmpdir);
+}
+
+static void test_timers(void)
+{
+    g_autofree char *tmpdir = g_dir_make_tmp("ot-migration-XXXXXX", NULL);
+    g_autofree char *path = g_strdup_printf("%s/vmstate", tmpdir);
+    g_autofree char *uri = g_strdup_printf("file:%s", path);
+
+    QTestState *from =
+        qtest_init("-machine ot-earlgrey,x-partial-migration=on");
+    QTestState *to =
+        qtest_init("-machine ot-earlgrey,x-partial-migration=on "
+                   "-incoming defer");
+
+    qtest_writel(from, OT_TIMER_BASE + TIMER_CFG0, 0x00020003u);
+    qtest_writel(from, OT_TIMER_BASE + TIMER_COMPARE_LOWER0_0, 0x12345678u);
+    qtest_writel(from, OT_TIMER_BASE + TIMER_COMPARE_UPPER0_0, 0x9abcu);
+    qtest_writel(from, OT_TIMER_BASE + TIMER_INTR_ENABLE0, 0x1u);
+
+    qtest_writel(from, OT_AON_TIMER_BASE + AON_TIMER_WKUP_THOLD, 0x1000u);
+    qtest_writel(from, OT_AON_TIMER_BASE + AON_TIMER_WDOG_BARK_THOLD, 0x2000u);
+    qtest_writel(from, OT_AON_TIMER_BASE + AON_TIMER_WDOG_BITE_THOLD, 0x3000u);
+
+    /* save the machine state, then restore it into another instance */
+    migrate_qmp(from, to, uri, NULL, "{}");
+    wait_for_migration_complete(from);
+
+    migrate_incoming_qmp(to, uri, "{}");
+    wait_for_migration_complete(to);
+
+    g_assert_cmphex(qtest_readl(to, OT_TIMER_BASE + TIMER_CFG0), ==,
+                    0x00020003u);
+    g_assert_cmphex(qtest_readl(to, OT_TIMER_BASE + TIMER_COMPARE_LOWER0_0),
+                    ==, 0x12345678u);
+    g_assert_cmphex(qtest_readl(to, OT_TIMER_BASE + TIMER_COMPARE_UPPER0_0),
+                    ==, 0x9abcu);
+    g_assert_cmphex(qtest_readl(to, OT_TIMER_BASE + TIMER_INTR_ENABLE0), ==,
+                    0x1u);
+
+    g_assert_cmphex(qtest_readl(to, OT_AON_TIMER_BASE + AON_TIMER_WKUP_THOLD),
+                    ==, 0x1000u);
+    g_assert_cmphex(
+        qtest_readl(to, OT_AON_TIMER_BASE + AON_TIMER_WDOG_BARK_THOLD), ==,
+        0x2000u);
+    g_assert_cmphex(
+        qtest_readl(to, OT_AON_TIMER_BASE + AON_TIMER_WDOG_BITE_THOLD), ==,
+        0x3000u);
+
+    qtest_quit(to);
+    qtest_quit(from);
+    g_unlink(path);
+    g_rmdir(tmpdir);
+}
+
+static void test_armed_timer(void)
+{
+    g_autofree char *tmpdir = g_dir_make_tmp("ot-migration-XXXXXX", NULL);
+    g_autofree char *path = g_strdup_printf("%s/vmstate", tmpdir);
+    g_autofree char *uri = g_strdup_printf("file:%s", path);
+
+    QTestState *from =
+        qtest_init("-machine ot-earlgrey,x-partial-migration=on");
+    QTestState *to =
+        qtest_init("-machine ot-earlgrey,x-partial-migration=on "
+                   "-incoming defer");
+
+    /* start the timer, with a compare value it has not reached yet */
+    qtest_writel(from, OT_TIMER_BASE + TIMER_COMPARE_LOWER0_0, 1000u);
+    qtest_writel(from, OT_TIMER_BASE + TIMER_COMPARE_UPPER0_0, 0u);
+    qtest_writel(from, OT_TIMER_BASE + TIMER_INTR_ENABLE0, 0x1u);
+    qtest_writel(from, OT_TIMER_BASE + TIMER_CTRL, 0x1u);
+    g_assert_cmphex(qtest_readl(from, OT_TIMER_BASE + TIMER_INTR_STATE0), ==,
+                    0u);
+
+    migrate_qmp(from, to, uri, NULL, "{}");
+    wait_for_migration_complete(from);
+
+    migrate_incoming_qmp(to, uri, "{}");
+    wait_for_migration_complete(to);
+
+    /* the pending deadline is restored: it expires on the destination */
+    g_assert_cmphex(qtest_readl(to, OT_TIMER_BASE + TIMER_CTRL), ==, 0x1u);
+    g_assert_cmphex(qtest_readl(to, OT_TIMER_BASE + TIMER_INTR_STATE0), ==,
+                    0u);
+    qtest_clock_step(to, 1000000);
+    g_assert_cmphex(qtest_readl(to, OT_TIMER_BASE + TIMER_INTR_STATE0), ==,
+                    0x1u);
+
+    qtest_quit(to);
+    qtest_quit(from);
+    g_unlink(path);
+    g_rmdir(tmpdir);
+}
+
+int main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+
+    qtest_add_func("/ot-migration-test/blocker", test_blocker);
+    qtest_add_func("/ot-migration-test/timers", test_timers);
+    qtest_add_func("/ot-migration-test/armed-timer", test_armed_timer);
+
+    return g_test_run();
+}